@@ -0,0 +1,155 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "mcpp/limiter.h"
+
+//
+// Admission throughput of the rate limiters at 1 to 64 threads, each thread calling TryAcquire in a loop. The rate is
+// range(0) tokens per second: 1e9 admits nearly everything (the cost of an admission), 1e5 rejects nearly everything (the
+// cost of a rejection, which does not write). A token bucket under a mutex, refilled the same way, is the baseline.
+//
+// Request/Release latency of FixedSizeLimiter against the mutex and condition variable version it replaced, with a limit
+// of range(0): uncontended with 64 (no thread ever waits), contended with 2.
+//
+
+class MutexTokenBucket {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  MutexTokenBucket(double rate, uint32_t burst) : rate_(rate), burst_(burst), tokens_(burst), last_(Clock::now()) {}
+
+  bool TryAcquire(uint32_t tokens = 1) {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> guard(lock_);
+    tokens_ = std::min<double>(burst_, tokens_ + std::chrono::duration<double>(now - last_).count() * rate_);
+    last_ = now;
+    if (tokens_ < tokens) {
+      return false;
+    }
+    tokens_ -= tokens;
+    return true;
+  }
+
+ private:
+  std::mutex lock_;
+  const double rate_;
+  const double burst_;
+  double tokens_;
+  Clock::time_point last_;
+};
+
+struct Mutex {
+  using Limiter = MutexTokenBucket;
+  static Limiter* Make(double rate) { return new Limiter(rate, 1000); }
+};
+
+struct Bucket {
+  using Limiter = mcpp::TokenBucket;
+  static Limiter* Make(double rate) { return new Limiter(rate, 1000); }
+};
+
+struct SlidingWindow {
+  using Limiter = mcpp::SlidingWindowLimiter;
+  static Limiter* Make(double rate) {
+    return new Limiter(static_cast<uint32_t>(std::min(rate / 10, 4e9)), std::chrono::milliseconds(100));
+  }
+};
+
+struct Sharded {
+  using Limiter = mcpp::ShardedTokenBucket;
+  static Limiter* Make(double rate) { return new Limiter(rate, 1000); }
+};
+
+template <typename Kind>
+static void BM_Admission(benchmark::State& state) {
+  static typename Kind::Limiter* limiter = nullptr;
+  // the loop starts and ends with a barrier of all the threads
+  if (state.thread_index() == 0) {
+    limiter = Kind::Make(static_cast<double>(state.range(0)));
+  }
+  int64_t admitted = 0;
+  for (auto _ : state) {
+    admitted += limiter->TryAcquire() ? 1 : 0;
+  }
+  if (state.thread_index() == 0) {
+    delete limiter;
+    limiter = nullptr;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["admitted"] = benchmark::Counter(static_cast<double>(admitted), benchmark::Counter::kIsRate);
+}
+
+static void Args(benchmark::internal::Benchmark* b) {
+  b->ArgName("rate")->Arg(1000 * 1000 * 1000)->Arg(100 * 1000)->ThreadRange(1, 64)->UseRealTime();
+}
+BENCHMARK_TEMPLATE(BM_Admission, Mutex)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Admission, Bucket)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Admission, SlidingWindow)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Admission, Sharded)->Apply(Args);
+
+// the previous FixedSizeLimiter, without its logging
+class MutexFixedSizeLimiter {
+ public:
+  MutexFixedSizeLimiter(uint32_t max_size, uint32_t request_timeout_ms)
+      : max_size_(max_size), request_timeout_ms_(request_timeout_ms) {}
+
+  int Request() {
+    std::unique_lock<std::mutex> lock_guard(mutex_);
+    while (total_cnt_ >= max_size_) {
+      if (condition_.wait_for(lock_guard, std::chrono::milliseconds(request_timeout_ms_)) == std::cv_status::timeout) {
+        return 1;
+      }
+    }
+    total_cnt_++;
+    return 0;
+  }
+
+  void Release() {
+    std::unique_lock<std::mutex> lock_guard(mutex_);
+    total_cnt_--;
+    condition_.notify_one();
+  }
+
+ private:
+  uint32_t max_size_;
+  uint32_t total_cnt_ = 0;
+  uint32_t request_timeout_ms_ = 0;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+template <typename Limiter>
+static void BM_RequestRelease(benchmark::State& state) {
+  static Limiter* limiter = nullptr;
+  if (state.thread_index() == 0) {
+    limiter = new Limiter(static_cast<uint32_t>(state.range(0)), 60 * 1000);
+  }
+  for (auto _ : state) {
+    if (limiter->Request() == 0) {
+      limiter->Release();
+    }
+  }
+  if (state.thread_index() == 0) {
+    delete limiter;
+    limiter = nullptr;
+  }
+}
+BENCHMARK_TEMPLATE(BM_RequestRelease, MutexFixedSizeLimiter)
+    ->ArgName("limit")
+    ->Arg(64)
+    ->Arg(2)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RequestRelease, mcpp::FixedSizeLimiter)
+    ->ArgName("limit")
+    ->Arg(64)
+    ->Arg(2)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mcpp/lock_free_pool.h"
+#include "mcpp/spinlock.h"
+
+//
+// Latency of LockFreePool::Getobj under contention: each thread takes an object, holds it for range(1) pauses, and
+// returns it, with more threads than objects (range(0)) from 2 threads on. The wait of every Getobj is recorded, and the
+// percentiles over all the threads are reported in nanoseconds, next to the mean time per iteration.
+//
+// Throughput of an uncontended checkout/return pair, with one obj per thread: with magazines (range(0) objs per
+// thread) the pair stays in the magazine of the thread, without (0) every checkout and return goes through the shared
+// queue and the Semaphore.
+//
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The latencies of all the threads of one run. Each thread records into a vector of its own, and adds it here once it
+// is done; the last one computes the percentiles.
+struct Latencies {
+  std::mutex lock;
+  std::vector<uint64_t> all;
+  int finished = 0;
+
+  void Add(benchmark::State& state, const std::vector<uint64_t>& mine) {
+    std::lock_guard<std::mutex> guard(lock);
+    all.insert(all.end(), mine.begin(), mine.end());
+    if (++finished < state.threads()) {
+      return;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [this](double p) {
+      return static_cast<double>(all[static_cast<size_t>(p * static_cast<double>(all.size() - 1))]);
+    };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["max_ns"] = static_cast<double>(all.back());
+    all.clear();
+    finished = 0;
+  }
+};
+
+Latencies latencies;
+
+}  // namespace
+
+static void BM_Getobj(benchmark::State& state) {
+  static mcpp::LockFreePool<std::string>* pool = nullptr;
+  // the loop starts and ends with a barrier of all the threads
+  if (state.thread_index() == 0) {
+    pool = new mcpp::LockFreePool<std::string>(static_cast<uint32_t>(state.range(0)), []() { return std::string(64, 'x'); });
+  }
+  const auto hold = static_cast<uint32_t>(state.range(1));
+  std::vector<uint64_t> mine;
+  for (auto _ : state) {
+    auto start = Clock::now();
+    auto obj = pool->Getobj();
+    mine.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    for (uint32_t i = 0; i < hold; ++i) {
+      mcpp::cpu_relax();
+    }
+  }
+  latencies.Add(state, mine);
+  if (state.thread_index() == 0) {
+    delete pool;
+    pool = nullptr;
+  }
+}
+BENCHMARK(BM_Getobj)
+    ->ArgNames({ "objs", "hold" })
+    ->ArgsProduct({ { 1, 4 }, { 0, 256 } })
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+static void BM_CheckoutReturn(benchmark::State& state) {
+  static mcpp::LockFreePool<std::string>* pool = nullptr;
+  if (state.thread_index() == 0) {
+    mcpp::LockFreePoolOptions options;
+    options.max_size = 64;
+    options.prewarm = 64;
+    options.magazine_size = static_cast<uint32_t>(state.range(0));
+    pool = new mcpp::LockFreePool<std::string>(options, []() { return std::string(64, 'x'); });
+  }
+  for (auto _ : state) {
+    auto obj = pool->Getobj();
+    benchmark::DoNotOptimize(obj->data());
+  }
+  if (state.thread_index() == 0) {
+    delete pool;
+    pool = nullptr;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CheckoutReturn)->ArgName("magazine")->Arg(0)->Arg(8)->ThreadRange(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -1,7 +1,15 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
 #include <random>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mcpp/flat_hash_map.h"
 
 struct T {
   uint64_t a;
@@ -10,53 +18,361 @@ struct T {
   uint64_t d;
 };
 
-static int max_size = 10000;
+using UnorderedMap = std::unordered_map<uint64_t, T>;
+using FlatHashMap = mcpp::FlatHashMap<uint64_t, T>;
+
+//
+// key streams
+//
+// Every key a benchmark looks up is generated before the timed loop from a fixed seed, so the loop only measures the map
+// and two runs look up the same keys. The tables are pre-sized (reserve) and filled with exactly `size` distinct keys.
+//
+// Keys are numbered: the key of index i < size is in the table, the key of index i >= size is a miss, so the hit ratio of
+// a stream is exact.
+//   uniform:     random 64-bit keys, uniform lookups
+//   zipf:        random 64-bit keys, Zipf(0.99) lookups: a few hot keys take most lookups, like most production caches
+//   sequential:  keys 0, 1, 2, ... looked up in increasing order
+//   adversarial: keys built from the table itself so that they all land in the same bucket, uniform lookups. For
+//                std::unordered_map, multiples of bucket_count() (libstdc++ takes the key modulo a prime bucket count);
+//                for FlatHashMap, keys whose mixed hash has the same home slot and the same tag. A lookup walks the whole
+//                chain or cluster, so these tables stop at 16K.
+//
+// Sizes go from 1K (L1) to 100M (far beyond L3, ~11GB for the flat table and ~7GB for std::unordered_map): use
+// --benchmark_filter to skip the sizes that do not fit in memory.
+
+static constexpr uint64_t kSeed = 42;
+static constexpr size_t kStreamLength = 1 << 20;
+
+enum class Pattern { Uniform, Zipf, Sequential, Adversarial };
+
+// bijective, so distinct indexes give distinct keys
+static uint64_t SplitMix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31U);
+}
+
+// the inverse of mcpp::detail::mix: x ^= x >> 33 is its own inverse on 64 bits, and an odd multiplier has an inverse
+// modulo 2^64 (Newton's iteration, each step doubles the number of correct low bits)
+static constexpr uint64_t InverseOf(uint64_t m) {
+  uint64_t inverse = m;
+  for (int i = 0; i < 5; i++) {
+    inverse *= 2 - m * inverse;
+  }
+  return inverse;
+}
+
+static uint64_t Unmix(uint64_t x) {
+  x ^= x >> 33U;
+  x *= InverseOf(0xff51afd7ed558ccdULL);
+  x ^= x >> 33U;
+  return x;
+}
+
+// a key in the same bucket as key 0 for each index, in a table reserved for `size` keys
+static uint64_t CollidingKey(const UnorderedMap& table, uint64_t index) {
+  return index * table.bucket_count();
+}
+
+// home slot 0 and tag 0: the index in the bits of the mixed hash above the home slot
+static uint64_t CollidingKey(const FlatHashMap& table, uint64_t index) {
+  const auto home_bits = static_cast<unsigned>(__builtin_ctzll(table.capacity()));
+  return Unmix(index << (7U + home_bits));
+}
+
+// The key of each index, for a table of `size` keys. The adversarial keys depend on the bucket count of the table, so a
+// KeySpace reserves an empty table the same way as Fill.
+template <typename Map>
+class KeySpace {
+ public:
+  KeySpace(Pattern pattern, uint64_t size) : pattern_(pattern) {
+    if (pattern == Pattern::Adversarial) {
+      shape_.reserve(size);
+    }
+  }
+
+  uint64_t operator()(uint64_t index) const {
+    switch (pattern_) {
+      case Pattern::Sequential:
+        return index;
+      case Pattern::Adversarial:
+        return CollidingKey(shape_, index);
+      default:
+        return SplitMix(index);
+    }
+  }
+
+ private:
+  Pattern pattern_;
+  Map shape_;
+};
+
+// Zipf distribution over [0, n), rank 0 being the most frequent (Gray et al., "Quickly generating billion-record synthetic
+// databases", as in YCSB). The constructor is O(n), every draw O(1).
+class ZipfDistribution {
+ public:
+  explicit ZipfDistribution(uint64_t n, double theta = 0.99) : n_(n), theta_(theta) {
+    for (uint64_t i = 1; i <= n; i++) {
+      zetan_ += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+    alpha_ = 1.0 / (1.0 - theta);
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta2 / zetan_);
+  }
+
+  template <typename Engine>
+  uint64_t operator()(Engine& engine) {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+    double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    auto rank = static_cast<uint64_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+    return std::min(rank, n_ - 1);
+  }
+
+ private:
+  uint64_t n_;
+  double theta_;
+  double zetan_ = 0.0;
+  double alpha_ = 0.0;
+  double eta_ = 0.0;
+};
+
+// `length` lookups into a table of `size` keys, hit_percent% of them hits
+template <typename Map>
+static std::vector<uint64_t> LookupStream(Pattern pattern, uint64_t size, int64_t hit_percent, size_t length) {
+  std::mt19937_64 engine(kSeed);
+  std::uniform_int_distribution<uint64_t> uniform(0, size - 1);
+  std::uniform_int_distribution<int64_t> percent(0, 99);
+  std::optional<ZipfDistribution> zipf;
+  if (pattern == Pattern::Zipf) {
+    zipf.emplace(size);
+  }
+  const KeySpace<Map> key(pattern, size);
+
+  std::vector<uint64_t> keys(length);
+  for (size_t i = 0; i < length; i++) {
+    uint64_t index = 0;
+    switch (pattern) {
+      case Pattern::Sequential:
+        index = i % size;
+        break;
+      case Pattern::Zipf:
+        index = (*zipf)(engine);
+        break;
+      default:
+        index = uniform(engine);
+    }
+    if (percent(engine) >= hit_percent) {
+      index += size;  // a miss, with the same distribution as the hits
+    }
+    keys[i] = key(index);
+  }
+  return keys;
+}
+
+// every key of the table once, in the order of the pattern (shuffled for the random patterns)
+template <typename Map>
+static std::vector<uint64_t> TableKeys(Pattern pattern, uint64_t size) {
+  const KeySpace<Map> key(pattern, size);
+  std::vector<uint64_t> keys(size);
+  for (uint64_t i = 0; i < size; i++) {
+    keys[i] = key(i);
+  }
+  if (pattern != Pattern::Sequential) {
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(kSeed));
+  }
+  return keys;
+}
+
+template <typename Map>
+static void Fill(Map& map, Pattern pattern, uint64_t size) {
+  const KeySpace<Map> key(pattern, size);
+  map.reserve(size);
+  for (uint64_t i = 0; i < size; i++) {
+    map[key(i)] = T{ i, i, i, i };
+  }
+}
+
+// Building a 100M table takes longer than the lookups, so the last table is kept between the runs of a benchmark and the
+// hit ratios of the same size.
+template <typename Map>
+static const Map& CachedTable(Pattern pattern, uint64_t size) {
+  static std::unique_ptr<Map> table;
+  static std::pair<Pattern, uint64_t> built;
+  if (!table || built != std::make_pair(pattern, size)) {
+    table.reset();
+    table = std::make_unique<Map>();
+    Fill(*table, pattern, size);
+    built = { pattern, size };
+  }
+  return *table;
+}
+
+static void Sizes(benchmark::internal::Benchmark* b) {
+  for (int64_t size : { 1LL << 10, 1LL << 14, 1LL << 17, 1LL << 20, 1LL << 23, 100'000'000LL }) {
+    for (int64_t hit_percent : { 100, 50, 0 }) {
+      b->Args({ size, hit_percent });
+    }
+  }
+  b->ArgNames({ "size", "hit%" });
+}
 
-static void unordered_map_find(benchmark::State& state) {
-  std::unordered_map<uint64_t, T> nums;
-  std::random_device seed;
-  std::mt19937 engine(seed());
-  std::uniform_int_distribution<int> dist(0, max_size);
-  for (uint64_t i = 0; i < state.max_iterations; i++) {
-    nums[dist(engine)] = T{ i, i, i, i };
+// every key of an adversarial table is in one chain or cluster: filling it is quadratic
+static void AdversarialSizes(benchmark::internal::Benchmark* b) {
+  for (int64_t size : { 1LL << 10, 1LL << 14 }) {
+    for (int64_t hit_percent : { 100, 0 }) {
+      b->Args({ size, hit_percent });
+    }
   }
+  b->ArgNames({ "size", "hit%" });
+}
+
+// the tables rebuilt during the run (erase) stop at 1M
+static void SmallSizes(benchmark::internal::Benchmark* b) {
+  for (int64_t size : { 1LL << 10, 1LL << 14, 1LL << 17, 1LL << 20 }) {
+    for (int64_t hit_percent : { 100, 50 }) {
+      b->Args({ size, hit_percent });
+    }
+  }
+  b->ArgNames({ "size", "hit%" });
+}
 
+template <typename Map, Pattern pattern>
+static void map_find(benchmark::State& state) {
+  const auto size = static_cast<uint64_t>(state.range(0));
+  const Map& nums = CachedTable<Map>(pattern, size);
+  auto keys = LookupStream<Map>(pattern, size, state.range(1), kStreamLength);
+
+  size_t i = 0;
   for (auto _ : state) {
-    nums.find(dist(engine));
+    benchmark::DoNotOptimize(nums.find(keys[i]));
+    i = (i + 1) & (kStreamLength - 1);
   }
+  state.SetItemsProcessed(state.iterations());
 }
-BENCHMARK(unordered_map_find);
+BENCHMARK_TEMPLATE(map_find, UnorderedMap, Pattern::Uniform)->Apply(Sizes);
+BENCHMARK_TEMPLATE(map_find, FlatHashMap, Pattern::Uniform)->Apply(Sizes);
+BENCHMARK_TEMPLATE(map_find, UnorderedMap, Pattern::Zipf)->Apply(Sizes);
+BENCHMARK_TEMPLATE(map_find, FlatHashMap, Pattern::Zipf)->Apply(Sizes);
+BENCHMARK_TEMPLATE(map_find, UnorderedMap, Pattern::Sequential)->Apply(Sizes);
+BENCHMARK_TEMPLATE(map_find, FlatHashMap, Pattern::Sequential)->Apply(Sizes);
+BENCHMARK_TEMPLATE(map_find, UnorderedMap, Pattern::Adversarial)->Apply(AdversarialSizes);
+BENCHMARK_TEMPLATE(map_find, FlatHashMap, Pattern::Adversarial)->Apply(AdversarialSizes);
 
-static void unordered_map_erase(benchmark::State& state) {
-  std::unordered_map<uint64_t, T> nums;
-  std::random_device seed;
-  std::mt19937 engine(seed());
-  std::uniform_int_distribution<int> dist(0, max_size);
-  for (uint64_t i = 0; i < state.max_iterations; i++) {
-    nums[dist(engine)] = T{ i, i, i, i };
+// Erase every key of the table once, in the order of the pattern, interleaved with misses for hit% < 100. When all the keys
+// are gone the table is rebuilt outside of the timing, so every erase sees a table between full and empty.
+template <typename Map, Pattern pattern>
+static void map_erase(benchmark::State& state) {
+  const auto size = static_cast<uint64_t>(state.range(0));
+  auto hits = TableKeys<Map>(pattern, size);
+  auto misses = LookupStream<Map>(pattern, size, 0, size);
+  std::mt19937_64 engine(kSeed);
+  std::uniform_int_distribution<int64_t> percent(0, 99);
+  std::vector<uint64_t> keys;
+  for (size_t hit = 0, miss = 0; hit < hits.size();) {
+    keys.push_back(percent(engine) < state.range(1) ? hits[hit++] : misses[miss++ % misses.size()]);
   }
 
+  Map nums;
+  Fill(nums, pattern, size);
+  size_t i = 0;
   for (auto _ : state) {
-    nums.erase(dist(engine));
+    benchmark::DoNotOptimize(nums.erase(keys[i]));
+    if (++i == keys.size()) {
+      state.PauseTiming();
+      Fill(nums, pattern, size);
+      i = 0;
+      state.ResumeTiming();
+    }
   }
+  state.SetItemsProcessed(state.iterations());
 }
-BENCHMARK(unordered_map_erase);
+BENCHMARK_TEMPLATE(map_erase, UnorderedMap, Pattern::Uniform)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(map_erase, FlatHashMap, Pattern::Uniform)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(map_erase, UnorderedMap, Pattern::Sequential)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(map_erase, FlatHashMap, Pattern::Sequential)->Apply(SmallSizes);
 
-static void unordered_map_find_erase(benchmark::State& state) {
-  std::unordered_map<uint64_t, T> nums;
-  std::random_device seed;
-  std::mt19937 engine(seed());
-  std::uniform_int_distribution<int> dist(0, max_size);
-  for (uint64_t i = 0; i < state.max_iterations; i++) {
-    nums[dist(engine)] = T{ i, i, i, i };
+// same as map_erase, through find + erase(iterator)
+template <typename Map, Pattern pattern>
+static void map_find_erase(benchmark::State& state) {
+  const auto size = static_cast<uint64_t>(state.range(0));
+  auto hits = TableKeys<Map>(pattern, size);
+  auto misses = LookupStream<Map>(pattern, size, 0, size);
+  std::mt19937_64 engine(kSeed);
+  std::uniform_int_distribution<int64_t> percent(0, 99);
+  std::vector<uint64_t> keys;
+  for (size_t hit = 0, miss = 0; hit < hits.size();) {
+    keys.push_back(percent(engine) < state.range(1) ? hits[hit++] : misses[miss++ % misses.size()]);
   }
 
+  Map nums;
+  Fill(nums, pattern, size);
+  size_t i = 0;
   for (auto _ : state) {
-    auto it = nums.find(dist(engine));
+    auto it = nums.find(keys[i]);
     if (it != nums.end())
       nums.erase(it);
+    if (++i == keys.size()) {
+      state.PauseTiming();
+      Fill(nums, pattern, size);
+      i = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(map_find_erase, UnorderedMap, Pattern::Uniform)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(map_find_erase, FlatHashMap, Pattern::Uniform)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(map_find_erase, UnorderedMap, Pattern::Sequential)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(map_find_erase, FlatHashMap, Pattern::Sequential)->Apply(SmallSizes);
+
+// build a table of `size` keys from scratch, growing from empty (reserve = 0) or pre-sized (reserve = 1)
+template <typename Map>
+static void map_insert(benchmark::State& state) {
+  const auto size = static_cast<uint64_t>(state.range(0));
+  auto keys = TableKeys<Map>(Pattern::Uniform, size);
+
+  for (auto _ : state) {
+    Map nums;
+    if (state.range(1) != 0) {
+      nums.reserve(size);
+    }
+    for (uint64_t key : keys) {
+      nums[key] = T{ key, key, key, key };
+    }
+    benchmark::DoNotOptimize(nums.size());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK_TEMPLATE(map_insert, UnorderedMap)
+    ->ArgsProduct({ { 1 << 10, 1 << 14, 1 << 17, 1 << 20 }, { 0, 1 } })
+    ->ArgNames({ "size", "reserve" });
+BENCHMARK_TEMPLATE(map_insert, FlatHashMap)
+    ->ArgsProduct({ { 1 << 10, 1 << 14, 1 << 17, 1 << 20 }, { 0, 1 } })
+    ->ArgNames({ "size", "reserve" });
+
+// visit every element: a walk over the node list vs a scan of the flat slot array
+template <typename Map>
+static void map_iterate(benchmark::State& state) {
+  const auto size = static_cast<uint64_t>(state.range(0));
+  const Map& nums = CachedTable<Map>(Pattern::Uniform, size);
+
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const auto& [key, value] : nums) {
+      sum += value.a;
+    }
+    benchmark::DoNotOptimize(sum);
   }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
 }
-BENCHMARK(unordered_map_find_erase);
+BENCHMARK_TEMPLATE(map_iterate, UnorderedMap)->RangeMultiplier(8)->Range(1 << 10, 1 << 20)->ArgName("size");
+BENCHMARK_TEMPLATE(map_iterate, FlatHashMap)->RangeMultiplier(8)->Range(1 << 10, 1 << 20)->ArgName("size");
 
-BENCHMARK_MAIN();
\ No newline at end of file
+BENCHMARK_MAIN();
@@ -1,29 +1,16 @@
-#include <chrono>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <forward_list>
-#include <iomanip>
-#include <iostream>
 #include <list>
+#include <memory>
 #include <numeric>
 #include <random>
-#include <string>
 #include <vector>
 
-const int SIZE = 100'000'000;
-
-template<typename T>
-void sumUp(T& t, const std::string& cont)
-{
-  std::cout << std::fixed << std::setprecision(10);
-  auto begin = std::chrono::steady_clock::now();
-  std::size_t res = std::accumulate(t.begin(), t.end(), 0LL);
-  std::chrono::duration<double> last = std::chrono::steady_clock::now() - begin;
-  std::cout << cont << '\n';
-  std::cout << "time: " << last.count() << '\n';
-  std::cout << "res: " << res << '\n';
-  std::cout << '\n';
-  std::cout << '\n';
-}
+#include "mcpp/node_pool.h"
 
 /**
     you read an int from memory more than the size of this one int is read from memory. An entire cache line is read from
@@ -35,38 +22,170 @@ void sumUp(T& t, const std::string& cont)
     A data structure such as std::vector, which stores its data in a contiguous memory block, is a cache line friendly data
     structure because each element in the cache line is typically used. This cache line friendliness also holds for a
     std::array, and std::string.
+
+    Every benchmark below sweeps the working set from L1 (16KB) through L2 and L3 to DRAM (256MB), so the output shows where
+    each cache level ends for a given data layout or access pattern. Run with `--benchmark_filter=<name>` to pick a group.
 */
-int main()
-{
-  std::cout << "\n";
-  std::random_device seed;
-  std::mt19937 engine(seed());
+
+static constexpr int64_t kCacheLine = 64;
+
+// working set sizes in bytes: 16KB, 128KB, 1MB, 8MB, 64MB, 256MB
+static void WorkingSets(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes : { 16LL << 10, 128LL << 10, 1LL << 20, 8LL << 20, 64LL << 20, 256LL << 20 }) {
+    b->Arg(bytes);
+  }
+}
+
+// up to 8MB, for the benchmarks that need much more memory than the working set
+static void SmallWorkingSets(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes : { 16LL << 10, 128LL << 10, 1LL << 20, 8LL << 20 }) {
+    b->Arg(bytes);
+  }
+}
+
+static std::vector<int> RandomInts(std::size_t n) {
+  std::mt19937 engine(42);
   std::uniform_int_distribution<int> dist(0, 100);
+  std::vector<int> v(n);
+  std::generate(v.begin(), v.end(), [&]() { return dist(engine); });
+  return v;
+}
 
-  std::vector<int> randNum;
-  randNum.reserve(SIZE);
-  for (int i = 0; i < SIZE; i++)
-  {
-    randNum.push_back(dist(engine));
+//
+// 1. container: std::accumulate over the same ints stored in vector/deque/list/forward_list
+//
+// The working set is the size of the int payload; the list nodes are larger (pointers + malloc header), and scattered
+// once the heap has been used for a while.
+template <typename Container>
+static void BM_Container(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0)) / sizeof(int);
+  auto data = RandomInts(n);
+  Container container(data.begin(), data.end());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(container.begin(), container.end(), 0LL));
   }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+BENCHMARK_TEMPLATE(BM_Container, std::vector<int>)->Apply(WorkingSets);
+BENCHMARK_TEMPLATE(BM_Container, std::deque<int>)->Apply(WorkingSets);
+BENCHMARK_TEMPLATE(BM_Container, std::list<int>)->Apply(WorkingSets);
+BENCHMARK_TEMPLATE(BM_Container, std::forward_list<int>)->Apply(WorkingSets);
+BENCHMARK_TEMPLATE(BM_Container, std::list<int, mcpp::NodePoolAllocator<int>>)->Apply(WorkingSets);
+BENCHMARK_TEMPLATE(BM_Container, std::forward_list<int, mcpp::NodePoolAllocator<int>>)->Apply(WorkingSets);
 
-  {
-    std::vector<int> vec(randNum.begin(), randNum.end());
-    sumUp(vec, "std::vector<int>");
+//
+// 1b. list nodes allocated in between other heap objects, as in a real program
+//
+// With the default allocator the nodes end up scattered between the other objects, each node on its own cache line. The
+// node pool keeps them packed in its slabs whatever else is allocated in between. The noise objects take ~40x the working
+// set, hence the smaller sweep.
+template <typename Container>
+static void BM_ContainerInterleaved(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0)) / sizeof(int);
+  auto data = RandomInts(n);
+  Container container;
+  std::vector<std::unique_ptr<char[]>> noise;
+  noise.reserve(n);
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<std::size_t> size(16, 256);
+  auto it = container.before_begin();
+  for (int value : data) {
+    it = container.insert_after(it, value);
+    noise.emplace_back(new char[size(engine)]);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(container.begin(), container.end(), 0LL));
   }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+BENCHMARK_TEMPLATE(BM_ContainerInterleaved, std::forward_list<int>)->Apply(SmallWorkingSets);
+BENCHMARK_TEMPLATE(BM_ContainerInterleaved, std::forward_list<int, mcpp::NodePoolAllocator<int>>)->Apply(SmallWorkingSets);
 
-  {
-    std::deque<int> deq(randNum.begin(), randNum.end());
-    sumUp(deq, "std::deque<int>");
+//
+// 2. stride: read one int every `stride` ints of a vector
+//
+// Up to a stride of 16 ints (one cache line) every line is still loaded, so the time per iteration barely drops while the
+// useful bytes/second fall. bytes_per_second counts the useful ints, cache_lines_per_second the lines actually touched.
+static void BM_Stride(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0)) / sizeof(int);
+  const auto stride = static_cast<std::size_t>(state.range(1));
+  auto data = RandomInts(n);
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (std::size_t i = 0; i < n; i += stride) {
+      sum += data[i];
+    }
+    benchmark::DoNotOptimize(sum);
   }
+  const auto reads = static_cast<int64_t>((n + stride - 1) / stride);
+  const auto lines = std::min(reads, state.range(0) / kCacheLine);
+  state.SetBytesProcessed(state.iterations() * reads * static_cast<int64_t>(sizeof(int)));
+  state.SetItemsProcessed(state.iterations() * reads);
+  state.counters["cache_lines_per_second"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * lines), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Stride)->ArgsProduct({ { 1LL << 20, 64LL << 20 }, { 1, 2, 4, 8, 16, 32, 64 } });
+
+//
+// 3. access pattern: sequential vs random vs pointer chasing, one int per 64-byte slot
+//
+// sequential: the hardware prefetcher streams the lines in.
+// random: the addresses are known in advance (an index array), so the CPU overlaps several cache misses.
+// pointer chasing: the next address depends on the current load, every miss pays the full latency.
+struct alignas(kCacheLine) Slot {
+  uint32_t next;  // index of the next slot for pointer chasing
+  int value;
+};
 
-  {
-    std::list<int> lst(randNum.begin(), randNum.end());
-    sumUp(lst, "std::list<int>");
+// a single random cycle through all slots (Sattolo's algorithm), so pointer chasing visits every slot once
+static std::vector<Slot> MakeSlots(std::size_t n) {
+  std::vector<uint32_t> order(n);
+  std::iota(order.begin(), order.end(), 0U);
+  std::mt19937 engine(42);
+  for (std::size_t i = n - 1; i > 0; --i) {
+    std::uniform_int_distribution<std::size_t> dist(0, i - 1);
+    std::swap(order[i], order[dist(engine)]);
   }
+  std::vector<Slot> slots(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    slots[order[i]].next = order[(i + 1) % n];
+    slots[i].value = static_cast<int>(i % 101);
+  }
+  return slots;
+}
+
+enum class Pattern { Sequential, Random, PointerChasing };
 
-  {
-    std::forward_list<int> forwardLst(randNum.begin(), randNum.end());
-    sumUp(forwardLst, "std::forward_list<int>");
+static void BM_AccessPattern(benchmark::State& state, Pattern pattern) {
+  const auto n = static_cast<std::size_t>(state.range(0)) / sizeof(Slot);
+  auto slots = MakeSlots(n);
+  std::vector<uint32_t> indexes(n);
+  std::iota(indexes.begin(), indexes.end(), 0U);
+  if (pattern == Pattern::Random) {
+    std::shuffle(indexes.begin(), indexes.end(), std::mt19937(7));
   }
+  for (auto _ : state) {
+    int64_t sum = 0;
+    if (pattern == Pattern::PointerChasing) {
+      uint32_t cur = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        sum += slots[cur].value;
+        cur = slots[cur].next;
+      }
+    } else {
+      for (uint32_t idx : indexes) {
+        sum += slots[idx].value;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
 }
+BENCHMARK_CAPTURE(BM_AccessPattern, sequential, Pattern::Sequential)->Apply(WorkingSets);
+BENCHMARK_CAPTURE(BM_AccessPattern, random, Pattern::Random)->Apply(WorkingSets);
+BENCHMARK_CAPTURE(BM_AccessPattern, pointer_chasing, Pattern::PointerChasing)->Apply(WorkingSets);
+
+BENCHMARK_MAIN();
@@ -1,150 +1,239 @@
+#include <benchmark/benchmark.h>
+
 #include <atomic>
-#include <condition_variable>
-#include <functional>  // for std::function
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <mutex>
-#include <unordered_map>
-
-// 简化的线程队列结构
-struct ThreadQueue {
-  std::mutex queueMutex;       // 保护这个队列的互斥锁 (ParkingLot桶锁的简化)
-  std::condition_variable cv;  // 用于挂起/唤醒此队列上等待的线程
-};
+#include <new>
 
-// 极度简化的 ParkingLot (仅用于演示lambda作用)
-class ParkingLot {
- public:
-  // 存储地址->队列的映射 (真实实现是并发哈希表)
-  static std::unordered_map<const void*, ThreadQueue> queues;
-  // 保护queues映射的全局锁 (真实实现分桶加锁)
-  static std::mutex globalMapMutex;
-
-  // 核心1: 有条件地停放线程
-  static bool parkConditionally(
-      const void* address,
-      std::function<bool()> validation,   // **关键Lambda 1: 验证条件**
-      std::function<void()> beforeSleep,  // **关键Lambda 2: 准备挂起前操作**
-      std::chrono::steady_clock::time_point timeout) {
-    // 1. 查找或创建对应地址的队列 (简化: 忽略并发，直接加全局锁)
-    std::unique_lock<std::mutex> mapLock(globalMapMutex);
-    ThreadQueue& queue = queues[address];  // 获取该地址对应的队列
-    mapLock.unlock();                      // (真实实现：锁定特定桶)
-
-    // 2. **锁定目标地址的队列** (模拟获得队列锁)
-    std::unique_lock<std::mutex> queueLock(queue.queueMutex);
-
-    // 3. **执行调用者提供的验证Lambda (Validation)**
-    //     - 调用者在此检查其锁/条件的状态是否仍满足停车条件
-    //     - 此Lambda在队列锁保护下执行，状态稳定！
-    if (!validation()) {
-      // 条件不再成立！(例如：锁突然可用了) -> 不挂起，返回false
-      return false;
-    }
+#if MCPP_HAS_BTHREAD
+#include <bthread/mutex.h>
+#endif
 
-    // 4. **当前线程即将进入队列并挂起**
-    //     - 在此简化版，我们假设线程ID已隐式加入队列概念
-    //     - (真实实现：记录线程信息到队列节点)
+#include "mcpp/parking_lot.h"
+#include "mcpp/spinlock.h"
 
-    // 5. **释放队列锁** (让其他线程可以操作此队列)
-    queueLock.unlock();
+// ParkingLot 的实现见 include/mcpp/parking_lot.h (分桶加锁的哈希表 + 每个线程一个侵入式队列节点)
+using mcpp::FunctionRef;
+using mcpp::ParkingLot;
 
-    // 6. **执行调用者提供的beforeSleep Lambda**
-    //     - **关键时机！** 已出队列临界区，但线程尚未挂起
-    //     - 调用者可在此执行重要操作 (如：解锁用户锁！)
-    beforeSleep();
+// 统计每个线程调用全局 operator new 的次数，用来检查停车/唤醒的路径上有没有内存分配
+// (数组和带 size 的形式一起替换，全部经过 malloc/free，避免不同形式的 new/delete 配对不上)
+static thread_local int64_t allocations = 0;
 
-    // 7. **真正挂起线程** (等待被unpark唤醒)
-    std::unique_lock<std::mutex> waitLock(queue.queueMutex);  // 重新获得锁以使用CV
-    if (queue.cv.wait_until(waitLock, timeout) == std::cv_status::timeout) {
-      // 处理超时 (简化省略)
-      return false;
-    }
-    // 被唤醒，返回成功
-    return true;
+static void* CountedMalloc(std::size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
   }
-
-  // 核心2: 唤醒一个停放线程
-  static void unparkOne(
-      const void* address,
-      std::function<void(bool didUnpark, bool queueEmpty)> callback) {  // **关键Lambda 3: 处理结果**
-
-    // 1. 查找对应地址的队列
-    std::unique_lock<std::mutex> mapLock(globalMapMutex);
-    auto it = queues.find(address);
-    if (it == queues.end()) {
-      // 没人在等！直接返回
-      callback(false, true);  // 告知：没唤醒线程，队列空(或不存在)
-      return;
-    }
-    ThreadQueue& queue = it->second;
-    mapLock.unlock();
-
-    // 2. **锁定目标队列**
-    std::unique_lock<std::mutex> queueLock(queue.queueMutex);
-
-    // 3. **尝试从队列中取出一个等待线程** (简化：我们假设队列非空)
-    bool didUnpark = true;    // (真实实现：检查队列并移除一个节点)
-    bool queueEmpty = false;  // (真实实现：检查移除后队列是否为空)
-
-    // 4. **执行唤醒操作**
-    queue.cv.notify_one();  // 唤醒一个线程
-
-    // 5. **执行调用者提供的回调Lambda (Callback)**
-    //     - 此Lambda在**队列锁保护下**执行！
-    //     - 调用者可基于唤醒结果(didUnpark, queueEmpty)原子更新其状态
-    callback(didUnpark, queueEmpty);
-
-    // 6. (队列锁随queueLock析构自动释放)
-  }
-};
-
-// 初始化静态成员
-std::unordered_map<const void*, ThreadQueue> ParkingLot::queues;
-std::mutex ParkingLot::globalMapMutex;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) {
+  return CountedMalloc(size);
+}
+void* operator new[](std::size_t size) {
+  return CountedMalloc(size);
+}
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+// 自旋等待时让出流水线 (x86 的 pause 指令)，其它平台退化为 yield
+using mcpp::cpu_relax;
+// test-and-test-and-set 自旋锁：只在锁看起来空闲时才 exchange，等待时只读本地缓存行 (其它自旋锁的对比见 benchmark/spinlock)
+using mcpp::TTASLock;
 
 class WTF_Lock {
  private:
-  std::atomic<uint8_t> m_state{ 0 };  // 假设8位原子变量
+  std::atomic<uint8_t> m_state{ 0 };  // 1 字节的锁
   static constexpr uint8_t isLockedBit = 0x01;
   static constexpr uint8_t hasParkedBit = 0x02;
+  // 停车前最多自旋的轮数：每轮的 pause 次数翻倍 (1, 2, 4, ... 512)，总共约 1000 个 pause，
+  // 足以覆盖短临界区 (microcontention)，长临界区则很快进入停车，不浪费 CPU
+  static constexpr int spinLimit = 10;
 
  public:
   void lock() {
-    // ... (尝试快速获取锁、自旋等逻辑省略) ...
-    // 最终需要停车：
-
-    // **关键点 1: 调用 parkConditionally 并传入两个Lambda**
-    ParkingLot::parkConditionally(
-        &m_state,           // 地址：锁的状态变量地址
-        [this]() -> bool {  // **Validation Lambda**
-          // 在ParkingLot队列锁保护下检查：
-          // 锁是否仍被持有(lockBit) 且 我们之前设置的hasParkedBit还在？
-          return (m_state.load() & (isLockedBit | hasParkedBit)) == (isLockedBit | hasParkedBit);
-        },
-        []() { /* beforeSleep Lambda: 在WTF::Lock的lock()中通常为空 */ },
-        std::chrono::steady_clock::time_point::max()  // 无超时
-    );
-    // 被唤醒后，线程已持有锁
+    // 快速路径：无竞争时一次 CAS 拿到锁
+    uint8_t expected = 0;
+    if (m_state.compare_exchange_weak(expected, isLockedBit, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return;
+    }
+    lockSlow();
+  }
+
+  bool try_lock() {
+    uint8_t current = m_state.load(std::memory_order_relaxed);
+    while (!(current & isLockedBit)) {
+      if (m_state.compare_exchange_weak(current, current | isLockedBit, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
   }
 
   void unlock() {
-    // ... (尝试快速释放锁逻辑省略：如果hasParkedBit没设，直接CAS清除lockBit) ...
-    // 需要唤醒等待者：
-
-    // **关键点 2: 调用 unparkOne 并传入一个Lambda**
-    ParkingLot::unparkOne(
-        &m_state,                                  // 地址：锁的状态变量地址
-        [this](bool didUnpark, bool queueEmpty) {  // **Callback Lambda**
-          // 在ParkingLot队列锁保护下更新状态：
-          if (didUnpark) {
-            if (queueEmpty) {
-              m_state.store(0);  // 唤醒了一个，队列空了：清除所有标志
-            } else {
-              m_state.store(hasParkedBit);  // 唤醒了一个，但队列还有等：保留hasParkedBit
-            }
-          } else {
-            // 没唤醒任何人 (不应该发生？) 但安全处理：清除lockBit，保留hasParkedBit?
-            m_state.store(hasParkedBit);
-          }
-        });
+    // 快速路径：没有线程停车 (hasParkedBit 没设)，直接 CAS 清除 lockBit
+    uint8_t expected = isLockedBit;
+    if (m_state.compare_exchange_weak(expected, 0, std::memory_order_release, std::memory_order_relaxed)) {
+      return;
+    }
+    unlockSlow();
+  }
+
+ private:
+  void lockSlow() {
+    int spinCount = 0;
+    for (;;) {
+      uint8_t current = m_state.load(std::memory_order_relaxed);
+
+      // 锁空闲：抢锁 (即使有线程在停车也可以抢，barging 让锁的吞吐更高)
+      if (!(current & isLockedBit)) {
+        if (m_state.compare_exchange_weak(current, current | isLockedBit, std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+          return;
+        }
+        continue;
+      }
+
+      // 还没有线程停车时先自旋 (指数退避)，已经有线程停车说明临界区较长，直接停车
+      if (!(current & hasParkedBit) && spinCount < spinLimit) {
+        for (int i = 0; i < (1 << spinCount); i++) {
+          cpu_relax();
+        }
+        spinCount++;
+        continue;
+      }
+
+      // 设置 hasParkedBit，告诉持锁线程 unlock 时要走慢路径唤醒我们
+      if (!(current & hasParkedBit)) {
+        if (!m_state.compare_exchange_weak(current, current | hasParkedBit, std::memory_order_relaxed)) {
+          continue;
+        }
+      }
+
+      // **关键点 1: 调用 parkConditionally 并传入两个Lambda**
+      ParkingLot::parkConditionally(
+          &m_state,           // 地址：锁的状态变量地址
+          [this]() -> bool {  // **Validation Lambda**
+            // 在ParkingLot队列锁保护下检查：
+            // 锁是否仍被持有(lockBit) 且 我们之前设置的hasParkedBit还在？
+            return (m_state.load() & (isLockedBit | hasParkedBit)) == (isLockedBit | hasParkedBit);
+          },
+          []() { /* beforeSleep Lambda: 在WTF::Lock的lock()中通常为空 */ });
+      // 被唤醒 (或者验证失败) 后重新抢锁：unlock 只是唤醒，不直接把锁交给我们
+    }
+  }
+
+  void unlockSlow() {
+    for (;;) {
+      uint8_t current = m_state.load(std::memory_order_relaxed);
+      // hasParkedBit 可能在 unlock 的 CAS 之后被停车超时的线程清掉了，重试快速路径
+      if (current == isLockedBit) {
+        if (m_state.compare_exchange_weak(current, 0, std::memory_order_release, std::memory_order_relaxed)) {
+          return;
+        }
+        continue;
+      }
+
+      // **关键点 2: 调用 unparkOne 并传入一个Lambda**
+      ParkingLot::unparkOne(
+          &m_state,                                  // 地址：锁的状态变量地址
+          [this](bool didUnpark, bool queueEmpty) {  // **Callback Lambda**
+            // 在ParkingLot队列锁保护下更新状态 (清除 lockBit)：
+            // 队列空了 (包括没唤醒任何人)：清除所有标志；队列还有等待者：保留 hasParkedBit
+            (void)didUnpark;
+            m_state.store(queueEmpty ? 0 : hasParkedBit, std::memory_order_release);
+          });
+      return;
+    }
+  }
+};
+
+//
+// 竞争测试：所有线程反复获取同一把锁，临界区内对共享计数器做 range(0) 次自增
+//   cs = 0:   只测加锁/解锁本身 (最激烈的竞争)
+//   cs = 16:  短临界区，自旋通常就能等到锁 (microcontention)
+//   cs = 256: 长临界区，自旋锁浪费 CPU，应该停车
+// 线程数 1 (无竞争的快速路径) 到 64 (超过核数时自旋锁的持锁线程会被抢占)
+//
+template <typename Mutex>
+static void BM_Lock(benchmark::State& state) {
+  static Mutex mutex;
+  static uint64_t shared = 0;
+  const int64_t cs = state.range(0);
+  for (auto _ : state) {
+    std::lock_guard<Mutex> lock(mutex);
+    for (int64_t i = 0; i < cs; i++) {
+      benchmark::DoNotOptimize(++shared);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["lock_bytes"] = benchmark::Counter(sizeof(Mutex), benchmark::Counter::kAvgThreads);
+}
+BENCHMARK_TEMPLATE(BM_Lock, WTF_Lock)->Arg(0)->Arg(16)->Arg(256)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Lock, std::mutex)->Arg(0)->Arg(16)->Arg(256)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Lock, TTASLock)->Arg(0)->Arg(16)->Arg(256)->ThreadRange(1, 64)->UseRealTime();
+#if MCPP_HAS_BTHREAD
+BENCHMARK_TEMPLATE(BM_Lock, bthread::Mutex)->Arg(0)->Arg(16)->Arg(256)->ThreadRange(1, 64)->UseRealTime();
+#endif
+
+//
+// 乒乓测试：两个线程轮流执行，轮不到自己时停车，执行完把 turn 交给对方并唤醒它，
+// 每次迭代每个线程都走一遍 park (轮到自己之前对方没交出来) + unpark
+//
+// 回调的类型由 Callback 决定：
+//   FunctionRef:   lambda 直接传给 ParkingLot，只传引用，不分配
+//   std::function: 先把 lambda 包装成 std::function (改成 FunctionRef 之前的接口就是这样传参的)，
+//                  validation 捕获了 24 字节，超过 libstdc++ std::function 的小对象缓冲 (16 字节)，每次停车都要分配
+// allocs_per_cycle 是每个线程每次迭代的 operator new 次数，FunctionRef 应该是 0
+//
+template <template <typename> class Callback>
+static void BM_ParkUnparkCycle(benchmark::State& state) {
+  static std::atomic<int64_t> turn{ 0 };
+  std::atomic<int64_t>& word = turn;
+  int64_t validations = 0;
+  int64_t parks = 0;
+
+  // 第一次停车会创建线程的 ThreadData (可能扩容哈希表)，放到计时和计数之外
+  ParkingLot::parkConditionally(&turn, []() { return false; }, []() {});
+
+  // 上一轮运行留下的 turn 在所有线程开始前就确定了，轮到本线程的值是 base + thread_index, +2, +4, ...
+  int64_t next = turn.load() + state.thread_index();
+  const int64_t before = allocations;
+  for (auto _ : state) {
+    while (word.load(std::memory_order_acquire) != next) {
+      auto not_my_turn = [&word, next, &validations]() {
+        validations++;
+        return word.load(std::memory_order_relaxed) != next;
+      };
+      auto count_park = [&parks]() { parks++; };
+      // FunctionRef 只引用 lambda，所以 lambda 要先有名字，不能引用一个语句结束就销毁的临时对象
+      ParkingLot::parkConditionally(&word, Callback<bool()>(not_my_turn), Callback<void()>(count_park));
+    }
+    word.store(next + 1, std::memory_order_release);
+    ParkingLot::unparkOne(&word, Callback<void(bool, bool)>([](bool, bool) {}));
+    next += 2;
   }
-};
\ No newline at end of file
+  const auto iterations = static_cast<double>(state.iterations());
+  state.counters["allocs_per_cycle"] =
+      benchmark::Counter(static_cast<double>(allocations - before) / iterations, benchmark::Counter::kAvgThreads);
+  state.counters["parks_per_cycle"] =
+      benchmark::Counter(static_cast<double>(parks) / iterations, benchmark::Counter::kAvgThreads);
+}
+BENCHMARK_TEMPLATE(BM_ParkUnparkCycle, FunctionRef)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParkUnparkCycle, std::function)->Threads(2)->UseRealTime();
+
+BENCHMARK_MAIN();
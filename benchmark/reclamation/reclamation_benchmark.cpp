@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mcpp/epoch.h"
+#include "mcpp/hazard_pointer.h"
+
+//
+// Safe memory reclamation on a read-mostly lock-free list: the nodes are never removed, each one holds a pointer to its
+// value, and a writer replaces a value with a new one and retires the old one. A reader traverses the list and reads every
+// value, protected by
+//   Ebr:       one EpochGuard per traversal (one fence), then plain loads
+//   Hp:        one HazardPointer per traversal, and a protect (store, fence, load again) per value
+//   SharedPtr: std::atomic_load of a std::shared_ptr per value (libstdc++ locks a spinlock of a global pool, and
+//              increments then decrements the reference count, a write to the value's line)
+//
+// Each thread traverses the list once per iteration, and replaces one value every range(1) iterations (0: never).
+//
+
+struct Value {
+  explicit Value(uint64_t value) : v(value) {}
+  uint64_t v;
+};
+
+struct Ebr {
+  using Slot = std::atomic<Value*>;
+
+  template <typename Node>
+  static uint64_t Sum(const Node* head) {
+    mcpp::EpochGuard guard;
+    uint64_t sum = 0;
+    for (const Node* node = head; node != nullptr; node = node->next) {
+      sum += node->value.load(std::memory_order_acquire)->v;
+    }
+    return sum;
+  }
+
+  static void Replace(Slot& slot, uint64_t v) {
+    mcpp::EpochDomain::global().retire(slot.exchange(new Value(v), std::memory_order_acq_rel));
+  }
+  static void Init(Slot& slot) { slot.store(new Value(0)); }
+  static void Destroy(Slot& slot) { delete slot.load(); }
+};
+
+struct Hp {
+  using Slot = std::atomic<Value*>;
+
+  template <typename Node>
+  static uint64_t Sum(const Node* head) {
+    mcpp::HazardPointer hp;
+    uint64_t sum = 0;
+    for (const Node* node = head; node != nullptr; node = node->next) {
+      sum += hp.protect(node->value)->v;
+    }
+    return sum;
+  }
+
+  static void Replace(Slot& slot, uint64_t v) { mcpp::retire(slot.exchange(new Value(v), std::memory_order_acq_rel)); }
+  static void Init(Slot& slot) { slot.store(new Value(0)); }
+  static void Destroy(Slot& slot) { delete slot.load(); }
+};
+
+struct SharedPtr {
+  using Slot = std::shared_ptr<Value>;
+
+  template <typename Node>
+  static uint64_t Sum(const Node* head) {
+    uint64_t sum = 0;
+    for (const Node* node = head; node != nullptr; node = node->next) {
+      sum += std::atomic_load(&node->value)->v;
+    }
+    return sum;
+  }
+
+  static void Replace(Slot& slot, uint64_t v) { std::atomic_store(&slot, std::make_shared<Value>(v)); }
+  static void Init(Slot& slot) { slot = std::make_shared<Value>(0); }
+  static void Destroy(Slot&) {}
+};
+
+template <typename Scheme>
+class ReadMostlyList {
+ public:
+  struct Node {
+    typename Scheme::Slot value;
+    Node* next = nullptr;
+  };
+
+  explicit ReadMostlyList(size_t size) : nodes_(size) {
+    for (size_t i = 0; i < size; i++) {
+      nodes_[i] = std::make_unique<Node>();
+      Scheme::Init(nodes_[i]->value);
+      if (i > 0) {
+        nodes_[i - 1]->next = nodes_[i].get();
+      }
+    }
+  }
+
+  ~ReadMostlyList() {
+    for (auto& node : nodes_) {
+      Scheme::Destroy(node->value);
+    }
+  }
+
+  uint64_t Sum() const { return Scheme::Sum(nodes_.front().get()); }
+
+  void Replace(size_t index, uint64_t v) { Scheme::Replace(nodes_[index % nodes_.size()]->value, v); }
+
+ private:
+  std::vector<std::unique_ptr<Node>> nodes_;
+};
+
+template <typename Scheme>
+static void BM_ReadMostly(benchmark::State& state) {
+  static ReadMostlyList<Scheme>* list = nullptr;
+  const auto size = static_cast<size_t>(state.range(0));
+  const int64_t write_every = state.range(1);
+  // the loop starts and ends with a barrier of all the threads
+  if (state.thread_index() == 0) {
+    list = new ReadMostlyList<Scheme>(size);
+  }
+  int64_t writes = 0;
+  uint64_t next = static_cast<uint64_t>(state.thread_index());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(list->Sum());
+    if (write_every != 0 && ++writes == write_every) {
+      writes = 0;
+      list->Replace(next, next);
+      next += 7;
+    }
+  }
+  if (state.thread_index() == 0) {
+    delete list;
+    list = nullptr;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void Args(benchmark::internal::Benchmark* b) {
+  b->ArgNames({ "size", "write_every" })->ArgsProduct({ { 16, 1024 }, { 0, 64 } })->ThreadRange(1, 16)->UseRealTime();
+}
+BENCHMARK_TEMPLATE(BM_ReadMostly, Ebr)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_ReadMostly, Hp)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_ReadMostly, SharedPtr)->Apply(Args);
+
+BENCHMARK_MAIN();
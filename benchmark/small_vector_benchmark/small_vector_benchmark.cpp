@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "mcpp/small_vector.h"
+#include "mcpp/vector.h"
+
+// count every call of the global operator new, so that each benchmark can report allocations per iteration. All the forms
+// are replaced together and go through malloc/free, so that a new of one form never meets a delete of another.
+static std::atomic<int64_t> allocations{ 0 };
+
+static void* CountedMalloc(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) {
+  return CountedMalloc(size);
+}
+void* operator new[](std::size_t size) {
+  return CountedMalloc(size);
+}
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+// build a vector of state.range(0) ints by push_back and drop it, like most of our short-lived vectors.
+template <typename Vec>
+static void BuildAndDrop(benchmark::State& state) {
+  const int64_t elements = state.range(0);
+  const int64_t before = allocations.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    Vec v;
+    for (int64_t i = 0; i < elements; ++i) {
+      v.push_back(static_cast<int>(i));
+    }
+    benchmark::DoNotOptimize(v.begin());
+    benchmark::ClobberMemory();
+  }
+  state.counters["allocs_per_iter"] = benchmark::Counter(
+      static_cast<double>(allocations.load(std::memory_order_relaxed) - before), benchmark::Counter::kAvgIterations);
+}
+
+// element counts below, at and just above the inline capacity of SmallVector<int, N> for N = 4, 8, 16, and far above it
+#define SIZES Arg(3)->Arg(4)->Arg(5)->Arg(8)->Arg(9)->Arg(16)->Arg(17)->Arg(32)
+
+BENCHMARK_TEMPLATE(BuildAndDrop, std::vector<int>)->SIZES;
+BENCHMARK_TEMPLATE(BuildAndDrop, vector::Vector<int>)->SIZES;
+BENCHMARK_TEMPLATE(BuildAndDrop, vector::SmallVector<int, 4>)->SIZES;
+BENCHMARK_TEMPLATE(BuildAndDrop, vector::SmallVector<int, 8>)->SIZES;
+BENCHMARK_TEMPLATE(BuildAndDrop, vector::SmallVector<int, 16>)->SIZES;
+
+// the move of a SmallVector copies the inline elements, the move of a std::vector only steals 3 pointers.
+template <typename Vec>
+static void MoveBackAndForth(benchmark::State& state) {
+  Vec a;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    a.push_back(static_cast<int>(i));
+  }
+  for (auto _ : state) {
+    Vec b(std::move(a));
+    a = std::move(b);
+    benchmark::DoNotOptimize(a.begin());
+  }
+}
+BENCHMARK_TEMPLATE(MoveBackAndForth, std::vector<int>)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(MoveBackAndForth, vector::SmallVector<int, 4>)->Arg(4)->Arg(16);
+BENCHMARK_TEMPLATE(MoveBackAndForth, vector::SmallVector<int, 16>)->Arg(4)->Arg(16);
+
+BENCHMARK_MAIN();
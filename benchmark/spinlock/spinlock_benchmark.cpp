@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <mutex>
+
+#include "mcpp/spinlock.h"
+
+using mcpp::CLHLock;
+using mcpp::MCSLock;
+using mcpp::TASLock;
+using mcpp::TicketLock;
+using mcpp::TTASLock;
+
+//
+// Throughput and fairness of the spinlocks against std::mutex.
+//
+// Every thread repeatedly takes the same lock, increments a shared counter range(0) times inside the critical section,
+// then a local one range(1) times outside of it (the think time: with 0 the lock is always contended, with 1024 the
+// threads mostly run in parallel). The thread counts go past the number of cores: once they do, a preempted owner (or,
+// with the FIFO locks, a preempted next owner) stalls everybody, and this is where std::mutex, which sleeps, wins.
+//
+// Fairness: "reacquired" is the fraction of the acquisitions where the lock went to the thread that released it last. The
+// unfair locks hand it back to the releasing thread, whose cache still has the line, which gives them their throughput and
+// starves the others; the FIFO locks (ticket, MCS, CLH) hand it to the longest waiter, and reacquire only when nobody
+// waits.
+//
+template <typename Lock>
+static void BM_Spinlock(benchmark::State& state) {
+  static Lock lock;
+  static uint64_t shared = 0;
+  static int last_owner = -1;
+  const int64_t cs = state.range(0);
+  const int64_t think = state.range(1);
+  const int me = state.thread_index();
+  uint64_t local = 0;
+  int64_t reacquired = 0;
+  for (auto _ : state) {
+    {
+      std::lock_guard<Lock> guard(lock);
+      if (last_owner == me) {
+        reacquired++;
+      }
+      last_owner = me;
+      for (int64_t i = 0; i < cs; i++) {
+        benchmark::DoNotOptimize(++shared);
+      }
+    }
+    for (int64_t i = 0; i < think; i++) {
+      benchmark::DoNotOptimize(++local);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["reacquired"] = benchmark::Counter(
+      static_cast<double>(reacquired) / static_cast<double>(state.iterations()), benchmark::Counter::kAvgThreads);
+}
+
+static void Args(benchmark::internal::Benchmark* b) {
+  b->ArgNames({ "cs", "think" })->ArgsProduct({ { 16, 256 }, { 0, 1024 } })->ThreadRange(1, 64)->UseRealTime();
+}
+BENCHMARK_TEMPLATE(BM_Spinlock, TASLock)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Spinlock, TTASLock)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Spinlock, TicketLock)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Spinlock, MCSLock)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Spinlock, CLHLock)->Apply(Args);
+BENCHMARK_TEMPLATE(BM_Spinlock, std::mutex)->Apply(Args);
+
+BENCHMARK_MAIN();
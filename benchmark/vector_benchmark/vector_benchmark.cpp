@@ -1,5 +1,14 @@
 #include <benchmark/benchmark.h>
 
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "mcpp/vector.h"
+
 struct T {
   std::string a;
   std::string b;
@@ -7,33 +16,173 @@ struct T {
   T(std::string a, std::string b) : a(a), b(b){};  // better performance
 };
 
+template <typename Container>
 static void Vector_PushBack(benchmark::State& state) {
-  std::vector<T> nums;
-  nums.reserve(state.max_iterations);
+  Container nums;
+  nums.reserve(static_cast<int>(state.max_iterations));
   for (auto _ : state) {
     nums.push_back(T("a", "b"));
   }
 }
-BENCHMARK(Vector_PushBack);
+BENCHMARK_TEMPLATE(Vector_PushBack, std::vector<T>);
+BENCHMARK_TEMPLATE(Vector_PushBack, vector::Vector<T>);
 
+template <typename Container>
 static void Vector_EmplaceBack(benchmark::State& state) {
-  std::vector<T> nums;
-  nums.reserve(state.max_iterations);
+  Container nums;
+  nums.reserve(static_cast<int>(state.max_iterations));
   for (auto _ : state) {
     nums.emplace_back(T("a", "b"));
   }
 }
-BENCHMARK(Vector_EmplaceBack);
+BENCHMARK_TEMPLATE(Vector_EmplaceBack, std::vector<T>);
+BENCHMARK_TEMPLATE(Vector_EmplaceBack, vector::Vector<T>);
 
+template <typename Container>
 static void Vector_EmplaceBack2(benchmark::State& state) {
-  std::vector<T> nums;
+  Container nums;
   // before reserve: Vector_EmplaceBack2       98.2 ns         98.2 ns     10440242
-  nums.reserve(state.max_iterations);
+  nums.reserve(static_cast<int>(state.max_iterations));
   // after reserve: Vector_EmplaceBack2       35.1 ns         35.1 ns     19976003
   for (auto _ : state) {
     nums.emplace_back("a", "b");
   }
 }
-BENCHMARK(Vector_EmplaceBack2);
+BENCHMARK_TEMPLATE(Vector_EmplaceBack2, std::vector<T>);
+BENCHMARK_TEMPLATE(Vector_EmplaceBack2, vector::Vector<T>);
+
+// without reserve: exercises the geometric growth path (reallocation + move of existing elements).
+template <typename Container>
+static void Vector_EmplaceBackGrow(benchmark::State& state) {
+  for (auto _ : state) {
+    Container nums;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      nums.emplace_back("a", "b");
+    }
+    benchmark::DoNotOptimize(nums.begin());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(Vector_EmplaceBackGrow, std::vector<T>)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(Vector_EmplaceBackGrow, vector::Vector<T>)->Range(8, 8 << 10);
+
+// an int with a user-provided copy constructor, so it is neither trivially copyable nor trivially relocatable and
+// vector::Vector falls back to the per-element loop.
+struct LoopInt {
+  int v = 0;
+  LoopInt() = default;
+  LoopInt(int v) : v(v) {}
+  LoopInt(const LoopInt& other) : v(other.v) {}
+  LoopInt& operator=(const LoopInt& other) = default;
+};
+
+template <typename E>
+static vector::Vector<E> MakeVector(int64_t size) {
+  vector::Vector<E> v;
+  v.reserve(static_cast<int>(size));
+  for (int64_t i = 0; i < size; ++i) {
+    v.emplace_back(static_cast<int>(i));
+  }
+  return v;
+}
+
+// int: a single memcpy, LoopInt: element-wise copy constructor
+template <typename E>
+static void Vector_Copy(benchmark::State& state) {
+  auto src = MakeVector<E>(state.range(0));
+  for (auto _ : state) {
+    vector::Vector<E> copied(src);
+    benchmark::DoNotOptimize(copied.begin());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(E)));
+}
+BENCHMARK_TEMPLATE(Vector_Copy, int)->RangeMultiplier(10)->Range(1000, 100'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(Vector_Copy, LoopInt)->RangeMultiplier(10)->Range(1000, 100'000'000)->Unit(benchmark::kMicrosecond);
+
+// int: a single memcpy, LoopInt: element-wise std::move_if_noexcept + destroy
+template <typename E>
+static void Vector_Reallocate(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto v = MakeVector<E>(state.range(0));
+    state.ResumeTiming();
+    v.reserve(v.capacity() * 2);
+    benchmark::DoNotOptimize(v.begin());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(E)));
+}
+BENCHMARK_TEMPLATE(Vector_Reallocate, int)->RangeMultiplier(10)->Range(1000, 100'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(Vector_Reallocate, LoopInt)->RangeMultiplier(10)->Range(1000, 100'000'000)->Unit(benchmark::kMicrosecond);
+
+// move a vector back and forth: the special members themselves are O(1), so the cost is the tracing policy.
+// (PutsTrace is not run here, it would flood the benchmark output, and it is orders of magnitude slower anyway.)
+template <typename Trace>
+static void Vector_MoveTrace(benchmark::State& state) {
+  vector::Vector<int, std::allocator<int>, Trace> a;
+  a.push_back(1);
+  for (auto _ : state) {
+    vector::Vector<int, std::allocator<int>, Trace> b(std::move(a));
+    a = std::move(b);
+    benchmark::DoNotOptimize(a.begin());
+  }
+  if constexpr (std::is_same_v<Trace, vector::CountingTrace>) {
+    state.counters["move_constructors"] =
+        static_cast<double>(vector::CountingTrace::count(vector::SpecialMember::MoveConstructor));
+    state.counters["destructors"] = static_cast<double>(vector::CountingTrace::count(vector::SpecialMember::Destructor));
+    vector::CountingTrace::reset();
+  }
+}
+BENCHMARK_TEMPLATE(Vector_MoveTrace, vector::NoTrace);
+BENCHMARK_TEMPLATE(Vector_MoveTrace, vector::CountingTrace);
+
+// build-and-drop: every iteration is one "request" that builds `kVectorsPerRequest` short-lived vectors of
+// state.range(0) ints by push_back (so they grow), and drops them all at the end of the request.
+static constexpr int kVectorsPerRequest = 1000;
+
+template <typename Vec, typename... Alloc>
+static int64_t BuildAndDrop(int64_t elements, const Alloc&... alloc) {
+  int64_t sum = 0;
+  for (int i = 0; i < kVectorsPerRequest; ++i) {
+    Vec v(alloc...);
+    for (int64_t j = 0; j < elements; ++j) {
+      v.push_back(static_cast<int>(j));
+    }
+    sum += v.size();
+  }
+  return sum;
+}
+
+using PmrIntVector = vector::Vector<int, std::pmr::polymorphic_allocator<int>>;
+
+// global operator new/delete through std::allocator
+static void Vector_BuildAndDrop_GlobalNew(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BuildAndDrop<vector::Vector<int>>(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * kVectorsPerRequest);
+}
+BENCHMARK(Vector_BuildAndDrop_GlobalNew)->RangeMultiplier(4)->Range(4, 1024);
+
+// a monotonic arena per request: deallocate is a no-op, everything is released at once when the request ends. The
+// initial buffer is reused across requests so that the steady state does not touch the global heap at all.
+static void Vector_BuildAndDrop_MonotonicArena(benchmark::State& state) {
+  std::vector<std::byte> buffer(64 << 20);
+  for (auto _ : state) {
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    benchmark::DoNotOptimize(BuildAndDrop<PmrIntVector>(state.range(0), std::pmr::polymorphic_allocator<int>(&arena)));
+  }
+  state.SetItemsProcessed(state.iterations() * kVectorsPerRequest);
+}
+BENCHMARK(Vector_BuildAndDrop_MonotonicArena)->RangeMultiplier(4)->Range(4, 1024);
+
+// a long-lived single-threaded pool: freed blocks are recycled by size class without locking.
+static void Vector_BuildAndDrop_UnsynchronizedPool(benchmark::State& state) {
+  std::pmr::unsynchronized_pool_resource pool;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BuildAndDrop<PmrIntVector>(state.range(0), std::pmr::polymorphic_allocator<int>(&pool)));
+  }
+  state.SetItemsProcessed(state.iterations() * kVectorsPerRequest);
+}
+BENCHMARK(Vector_BuildAndDrop_UnsynchronizedPool)->RangeMultiplier(4)->Range(4, 1024);
 
-BENCHMARK_MAIN();
\ No newline at end of file
+BENCHMARK_MAIN();
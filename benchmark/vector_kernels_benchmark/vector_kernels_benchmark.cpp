@@ -0,0 +1,194 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "mcpp/vector.h"
+#include "mcpp/vector_kernels.h"
+
+using vector::kernels::Isa;
+
+// same data as memory_access_main.cpp: 100M random ints in [0, 100]
+static const int SIZE = 100'000'000;
+
+static vector::Vector<int> RandomInts(int size, unsigned seed) {
+  std::mt19937 engine(seed);
+  std::uniform_int_distribution<int> dist(0, 100);
+  vector::Vector<int> v;
+  v.reserve(size);
+  for (int i = 0; i < size; i++) {
+    v.push_back(dist(engine));
+  }
+  return v;
+}
+
+static vector::Vector<int>& X() {
+  static vector::Vector<int> x = RandomInts(SIZE, 1);
+  return x;
+}
+static vector::Vector<int>& Y() {
+  static vector::Vector<int> y = RandomInts(SIZE, 2);
+  return y;
+}
+static vector::Vector<double>& XD() {
+  static vector::Vector<double> x = [] {
+    vector::Vector<double> v;
+    v.reserve(SIZE);
+    for (int i : X()) {
+      v.push_back(i);
+    }
+    return v;
+  }();
+  return x;
+}
+
+static void SetBytes(benchmark::State& state, int64_t bytes_per_iteration) {
+  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
+}
+
+// the baseline of memory_access_main.cpp's sumUp
+static void Sum_StdAccumulate(benchmark::State& state) {
+  auto& x = X();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(x.begin(), x.end(), 0LL));
+  }
+  SetBytes(state, int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(Sum_StdAccumulate)->Unit(benchmark::kMillisecond);
+
+static void Sum_Kernel(benchmark::State& state, Isa isa) {
+  if (!vector::kernels::supported(isa)) {
+    state.SkipWithError("instruction set not supported by this CPU");
+    return;
+  }
+  auto& x = X();
+  const auto& k = vector::kernels::table(isa);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(k.sum_i32(x.begin(), static_cast<std::size_t>(x.size())));
+  }
+  SetBytes(state, int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK_CAPTURE(Sum_Kernel, scalar, Isa::Scalar)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(Sum_Kernel, sse41, Isa::Sse41)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(Sum_Kernel, avx2, Isa::Avx2)->Unit(benchmark::kMillisecond);
+
+// a working set that fits in L2, where the kernels are compute bound rather than memory bound
+static void SumL2_StdAccumulate(benchmark::State& state) {
+  auto& x = X();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(x.begin(), x.begin() + state.range(0), 0LL));
+  }
+  SetBytes(state, state.range(0) * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(SumL2_StdAccumulate)->Arg(64 << 10);
+
+static void SumL2_Kernel(benchmark::State& state, Isa isa) {
+  if (!vector::kernels::supported(isa)) {
+    state.SkipWithError("instruction set not supported by this CPU");
+    return;
+  }
+  auto& x = X();
+  const auto& k = vector::kernels::table(isa);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(k.sum_i32(x.begin(), static_cast<std::size_t>(state.range(0))));
+  }
+  SetBytes(state, state.range(0) * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK_CAPTURE(SumL2_Kernel, scalar, Isa::Scalar)->Arg(64 << 10);
+BENCHMARK_CAPTURE(SumL2_Kernel, sse41, Isa::Sse41)->Arg(64 << 10);
+BENCHMARK_CAPTURE(SumL2_Kernel, avx2, Isa::Avx2)->Arg(64 << 10);
+
+// the other kernels through the runtime dispatch, against their std counterparts
+static void MinMax_Std(benchmark::State& state) {
+  auto& x = X();
+  for (auto _ : state) {
+    auto [lo, hi] = std::minmax_element(x.begin(), x.end());
+    benchmark::DoNotOptimize(*lo + *hi);
+  }
+  SetBytes(state, int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(MinMax_Std)->Unit(benchmark::kMillisecond);
+
+static void MinMax_Kernel(benchmark::State& state) {
+  auto& x = X();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(vector::kernels::min(x) + vector::kernels::max(x));
+  }
+  SetBytes(state, int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(MinMax_Kernel)->Unit(benchmark::kMillisecond);
+
+static void Dot_StdInnerProduct(benchmark::State& state) {
+  auto& x = X();
+  auto& y = Y();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::inner_product(x.begin(), x.end(), y.begin(), 0LL));
+  }
+  SetBytes(state, 2 * int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(Dot_StdInnerProduct)->Unit(benchmark::kMillisecond);
+
+static void Dot_Kernel(benchmark::State& state) {
+  auto& x = X();
+  auto& y = Y();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(vector::kernels::dot(x, y));
+  }
+  SetBytes(state, 2 * int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(Dot_Kernel)->Unit(benchmark::kMillisecond);
+
+static void AxpyDouble_StdTransform(benchmark::State& state) {
+  auto& x = XD();
+  vector::Vector<double> y(SIZE);
+  for (auto _ : state) {
+    std::transform(x.begin(), x.end(), y.begin(), y.begin(), [](double a, double b) { return 0.5 * a + b; });
+    benchmark::ClobberMemory();
+  }
+  SetBytes(state, 3 * int64_t{ SIZE } * static_cast<int64_t>(sizeof(double)));
+}
+BENCHMARK(AxpyDouble_StdTransform)->Unit(benchmark::kMillisecond);
+
+static void AxpyDouble_Kernel(benchmark::State& state) {
+  auto& x = XD();
+  vector::Vector<double> y(SIZE);
+  for (auto _ : state) {
+    vector::kernels::axpy(0.5, x, y);
+    benchmark::ClobberMemory();
+  }
+  SetBytes(state, 3 * int64_t{ SIZE } * static_cast<int64_t>(sizeof(double)));
+}
+BENCHMARK(AxpyDouble_Kernel)->Unit(benchmark::kMillisecond);
+
+static void PrefixSum_StdPartialSum(benchmark::State& state) {
+  auto& x = X();
+  vector::Vector<int> scan(SIZE);
+  for (auto _ : state) {
+    std::partial_sum(x.begin(), x.end(), scan.begin());
+    benchmark::ClobberMemory();
+  }
+  SetBytes(state, 2 * int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(PrefixSum_StdPartialSum)->Unit(benchmark::kMillisecond);
+
+// copy then scan in place, to read and write the same amount of memory as std::partial_sum
+static void PrefixSum_Kernel(benchmark::State& state) {
+  auto& x = X();
+  vector::Vector<int> scan(SIZE);
+  for (auto _ : state) {
+    std::copy(x.begin(), x.end(), scan.begin());
+    vector::kernels::prefix_sum(scan);
+    benchmark::ClobberMemory();
+  }
+  SetBytes(state, 2 * int64_t{ SIZE } * static_cast<int64_t>(sizeof(int)));
+}
+BENCHMARK(PrefixSum_Kernel)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::AddCustomContext("kernels_isa", vector::kernels::isa_name(vector::kernels::best_isa()));
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -1,5 +1,9 @@
 set(sources
     src/vector.cpp
+    src/vector_kernels.cpp
+    src/parking_lot.cpp
+    src/hazard_pointer.cpp
+    src/epoch.cpp
 )
 
 set(exe_sources
@@ -8,6 +12,20 @@ set(exe_sources
 
 set(headers
     include/mcpp/vector.h
+    include/mcpp/vector_trace.h
+    include/mcpp/small_vector.h
+    include/mcpp/vector_kernels.h
+    include/mcpp/node_pool.h
+    include/mcpp/flat_hash_map.h
+    include/mcpp/function_ref.h
+    include/mcpp/parking_lot.h
+    include/mcpp/parking_primitives.h
+    include/mcpp/spinlock.h
+    include/mcpp/hazard_pointer.h
+    include/mcpp/epoch.h
+    include/mcpp/metrics.h
+    include/mcpp/lock_free_pool.h
+    include/mcpp/limiter.h
     include/mcpp/output_container.h
 )
 
@@ -18,8 +36,13 @@ set(test_sources
   src/app/mysql_test.cpp
   # concurrency
   src/concurrency/atomic_test.cpp
+  src/concurrency/epoch_test.cpp
   src/concurrency/future_test.cpp
+  src/concurrency/hazard_pointer.cpp
   src/concurrency/lock_test.cpp
+  src/concurrency/parking_lot_test.cpp
+  src/concurrency/parking_primitives_test.cpp
+  src/concurrency/spinlock_test.cpp
   # c
   src/c/c_lib_test.cpp
   src/c/c_test.cpp
@@ -37,6 +60,12 @@ set(test_sources
   src/oop_test.cpp
   src/lambda_test.cpp
   src/vector_test.cpp
+  src/small_vector_test.cpp
+  src/vector_kernels_test.cpp
+  src/node_pool_test.cpp
+  src/flat_hash_map_test.cpp
+  src/function_ref_test.cpp
+  src/metrics_test.cpp
   src/containers_test.cpp
   src/class_test.cpp
   src/lifetime_test.cpp
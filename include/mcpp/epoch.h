@@ -0,0 +1,104 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mcpp
+{
+  // Epoch-based reclamation (Fraser, "Practical lock-freedom", 2004).
+  //
+  // Readers access the shared objects inside critical sections (EpochGuard), which announce the global epoch they started
+  // in. A retired object is tagged with the global epoch, and the epoch only advances once every thread in a critical
+  // section has caught up with it, so an object retired in epoch e cannot be reached by any reader once the epoch is
+  // e + 2. Compared to hazard pointers, a reader pays one fence per critical section instead of one per object it
+  // accesses, but a reader that stays in a critical section blocks all reclamation: keep the critical sections short.
+  //
+  // Each thread frees its retired objects in batches, once it retired kBatchSize of them since its last attempt.
+
+  struct EpochThreadState;
+
+  namespace detail
+  {
+    // the records are never freed: a thread that exits leaves its record inactive for others to take
+    struct alignas(64) EpochRecord
+    {
+      // the epoch of the critical section the thread is in, shifted left by one with the lowest bit set, or 0
+      std::atomic<std::uint64_t> state{ 0 };
+      std::atomic<bool> active{ false };
+      EpochRecord* next{ nullptr };  // the list of all the records of the domain, only prepended to
+    };
+  }  // namespace detail
+
+  class EpochDomain
+  {
+   public:
+    // the process-wide domain, never destroyed so that it outlives every thread and every static object using it
+    static EpochDomain& global();
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // Delete `ptr` with a default-constructed D once no critical section that may have reached it is still running.
+    // `ptr` must be unlinked already.
+    template<typename T, typename D = std::default_delete<T>>
+    void retire(T* ptr)
+    {
+      push_retired({ ptr, [](void* p) { D()(static_cast<T*>(p)); }, 0 });
+    }
+
+    // Try to advance the epoch, and free the retired objects of this thread, and those left behind by exited threads,
+    // that are old enough. When no thread is in a critical section, two calls free everything retired before them.
+    void reclaim();
+
+    std::uint64_t epoch() const
+    {
+      return epoch_.load(std::memory_order_acquire);
+    }
+
+   private:
+    friend class EpochGuard;
+    friend struct EpochThreadState;
+
+    struct Retired
+    {
+      void* ptr;
+      void (*deleter)(void*);
+      std::uint64_t epoch;
+    };
+
+    EpochDomain() = default;
+    ~EpochDomain() = default;
+
+    detail::EpochRecord* acquire_record();
+    void push_retired(Retired retired);
+    // advance the epoch if every thread in a critical section is in the current one, returns the epoch
+    std::uint64_t try_advance();
+    // free the objects of the thread (and the orphans) retired two epochs ago or more
+    void collect(EpochThreadState& state);
+
+    std::atomic<std::uint64_t> epoch_{ 1 };
+    std::atomic<detail::EpochRecord*> records_{ nullptr };
+    // the retired objects of the threads that exited, adopted by the next collect
+    std::mutex orphans_lock_;
+    std::vector<Retired> orphans_;
+  };
+
+  // A critical section: the objects read from the shared structures inside it stay valid until it ends. Nests.
+  class EpochGuard
+  {
+   public:
+    EpochGuard();
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+    ~EpochGuard();
+
+   private:
+    EpochThreadState& state_;
+  };
+}  // namespace mcpp
+
+#endif  // EPOCH_H
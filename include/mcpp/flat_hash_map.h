@@ -0,0 +1,590 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace mcpp
+{
+  namespace detail
+  {
+    // one control byte per slot: the 7 low bits of the hash (h2) if the slot is full, kEmpty otherwise, so that a lookup
+    // compares 16 slots at once with two SSE2 instructions before touching any key.
+    using ctrl_t = signed char;
+    inline constexpr ctrl_t kEmpty = -128;
+
+    struct Group
+    {
+      static constexpr std::size_t kWidth = 16;
+
+#if defined(__SSE2__)
+      explicit Group(const ctrl_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))  // NOLINT
+      {
+      }
+      // bit i is set if slot i of the group has the tag h2
+      std::uint32_t match(ctrl_t h2) const
+      {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2))));
+      }
+      // bit i is set if slot i of the group is empty (kEmpty is the only control byte with the sign bit)
+      std::uint32_t match_empty() const
+      {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl));
+      }
+
+      __m128i ctrl;
+#else
+      explicit Group(const ctrl_t* p) : ctrl(p)
+      {
+      }
+      std::uint32_t match(ctrl_t h2) const
+      {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < kWidth; ++i)
+        {
+          mask |= static_cast<std::uint32_t>(ctrl[i] == h2) << i;
+        }
+        return mask;
+      }
+      std::uint32_t match_empty() const
+      {
+        return match(kEmpty);
+      }
+
+      const ctrl_t* ctrl;
+#endif
+    };
+
+    // std::hash of integers is the identity on the usual standard libraries, mix it so that both the position (high bits)
+    // and the tag (low 7 bits) depend on every bit of the key
+    inline std::size_t mix(std::size_t h)
+    {
+      std::uint64_t x = h;
+      x ^= x >> 33U;
+      x *= 0xff51afd7ed558ccdULL;
+      x ^= x >> 33U;
+      return x;
+    }
+  }  // namespace detail
+
+  // An open-addressing hash map storing its elements in one flat array, SwissTable-style: a parallel array of control
+  // bytes holds a 7-bit tag of each element's hash, and a lookup scans 16 control bytes with SSE2 before comparing keys.
+  //
+  // Collisions are resolved by linear probing, and erase shifts the following elements of the cluster back instead of
+  // leaving a tombstone, so the table never degrades with erase-heavy workloads and never needs a cleanup rehash. The
+  // capacity is a power of two (at least 16) and the table grows x2 past a load factor of 3/4.
+  //
+  // Differences with std::unordered_map: erase and insert invalidate all iterators and references (elements move), erase
+  // takes an iterator but does not return the next one, and there is no bucket interface.
+  template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+  class FlatHashMap : private Hash, private KeyEqual
+  {
+    using ctrl_t = detail::ctrl_t;
+    using Group = detail::Group;
+
+   public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+
+    // Walks the table a group of 16 control bytes at a time and keeps the full slots of the current group in a bit mask,
+    // so that ++ only depends on the mask and not on the previous load.
+    template<bool Const>
+    class Iterator
+    {
+      friend class FlatHashMap;
+      friend class Iterator<!Const>;
+
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = std::pair<const K, V>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+      using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+      Iterator() = default;
+      // iterator -> const_iterator
+      template<bool C = Const, typename = std::enable_if_t<C>>
+      Iterator(const Iterator<false>& other)  // NOLINT(google-explicit-constructor)
+          : group(other.group),
+            group_slots(other.group_slots),
+            end(other.end),
+            mask(other.mask),
+            offset(other.offset)
+      {
+      }
+
+      reference operator*() const
+      {
+        return group_slots[offset];
+      }
+      pointer operator->() const
+      {
+        return group_slots + offset;
+      }
+      Iterator& operator++()
+      {
+        next();
+        return *this;
+      }
+      Iterator operator++(int)
+      {
+        Iterator old = *this;
+        ++*this;
+        return old;
+      }
+      friend bool operator==(const Iterator& a, const Iterator& b)
+      {
+        return a.group + a.offset == b.group + b.offset;
+      }
+      friend bool operator!=(const Iterator& a, const Iterator& b)
+      {
+        return !(a == b);
+      }
+
+     private:
+      // the first full slot from `c` on
+      Iterator(const ctrl_t* c, pointer s, const ctrl_t* e) : group(c), group_slots(s), end(e)
+      {
+        load();
+        next();
+      }
+
+      // the full slots of the group, without the mirrored control bytes past `end`
+      void load()
+      {
+        if (group == end)
+        {
+          mask = 0;
+          return;
+        }
+        mask = ~Group(group).match_empty() & 0xFFFFU;
+        auto left = static_cast<std::size_t>(end - group);
+        if (left < Group::kWidth)
+        {
+          mask &= (1U << left) - 1;
+        }
+      }
+
+      // move to the lowest full slot of the mask, loading the next groups until there is one
+      void next()
+      {
+        while (mask == 0 && group != end)
+        {
+          auto step = std::min(static_cast<std::ptrdiff_t>(Group::kWidth), end - group);
+          group += step;
+          group_slots += step;
+          load();
+        }
+        if (mask == 0)
+        {
+          offset = 0;
+          return;
+        }
+        offset = static_cast<std::ptrdiff_t>(__builtin_ctz(mask));
+        mask &= mask - 1;
+      }
+
+      const ctrl_t* group{};
+      pointer group_slots{};
+      const ctrl_t* end{};
+      std::uint32_t mask{};
+      std::ptrdiff_t offset{};
+    };
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    // room for `n` elements without rehashing
+    explicit FlatHashMap(size_type n)
+    {
+      reserve(n);
+    }
+
+    FlatHashMap(std::initializer_list<value_type> list) : FlatHashMap(list.size())
+    {
+      for (const value_type& value : list)
+      {
+        try_emplace(value.first, value.second);
+      }
+    }
+
+    FlatHashMap(const FlatHashMap& input) : Hash(input), KeyEqual(input)
+    {
+      reserve(input.sz);
+      for (const value_type& value : input)
+      {
+        insert_unique(value.first, value);
+      }
+    }
+    FlatHashMap& operator=(const FlatHashMap& input)
+    {
+      if (this != &input)
+      {
+        FlatHashMap copy(input);
+        swap(copy);
+      }
+      return *this;
+    }
+
+    FlatHashMap(FlatHashMap&& input) noexcept : Hash(std::move(input)), KeyEqual(std::move(input))
+    {
+      swap(input);
+    }
+    FlatHashMap& operator=(FlatHashMap&& input) noexcept
+    {
+      if (this != &input)
+      {
+        FlatHashMap moved(std::move(input));
+        swap(moved);
+      }
+      return *this;
+    }
+
+    ~FlatHashMap()
+    {
+      destroy_and_deallocate();
+    }
+
+    void swap(FlatHashMap& other) noexcept
+    {
+      using std::swap;
+      swap(static_cast<Hash&>(*this), static_cast<Hash&>(other));
+      swap(static_cast<KeyEqual&>(*this), static_cast<KeyEqual&>(other));
+      swap(ctrl, other.ctrl);
+      swap(slots, other.slots);
+      swap(sz, other.sz);
+      swap(cap, other.cap);
+    }
+
+    size_type size() const
+    {
+      return sz;
+    }
+    bool empty() const
+    {
+      return sz == 0;
+    }
+    size_type capacity() const
+    {
+      return cap;
+    }
+
+    iterator begin()
+    {
+      return iterator(ctrl, slots, ctrl + cap);
+    }
+    iterator end()
+    {
+      return iterator(ctrl + cap, slots + cap, ctrl + cap);
+    }
+    const_iterator begin() const
+    {
+      return const_iterator(ctrl, slots, ctrl + cap);
+    }
+    const_iterator end() const
+    {
+      return const_iterator(ctrl + cap, slots + cap, ctrl + cap);
+    }
+
+    iterator find(const K& key)
+    {
+      size_type i = find_index(key);
+      return i == npos ? end() : iterator_at(i);
+    }
+    const_iterator find(const K& key) const
+    {
+      size_type i = find_index(key);
+      return i == npos ? end() : const_iterator(ctrl + i, slots + i, ctrl + cap);
+    }
+    bool contains(const K& key) const
+    {
+      return find_index(key) != npos;
+    }
+    size_type count(const K& key) const
+    {
+      return contains(key) ? 1 : 0;
+    }
+
+    V& at(const K& key)
+    {
+      size_type i = find_index(key);
+      if (i == npos)
+      {
+        throw std::out_of_range("FlatHashMap::at");
+      }
+      return slots[i].second;
+    }
+    const V& at(const K& key) const
+    {
+      size_type i = find_index(key);
+      if (i == npos)
+      {
+        throw std::out_of_range("FlatHashMap::at");
+      }
+      return slots[i].second;
+    }
+
+    V& operator[](const K& key)
+    {
+      return try_emplace(key).first->second;
+    }
+
+    // construct V from `args` only if the key is not there yet
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+    {
+      size_type i = find_index(key);
+      if (i != npos)
+      {
+        return { iterator_at(i), false };
+      }
+      reserve(sz + 1);
+      i = insert_unique(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+      return { iterator_at(i), true };
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+      return try_emplace(value.first, value.second);
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& value)
+    {
+      auto result = try_emplace(key, std::forward<M>(value));
+      if (!result.second)
+      {
+        result.first->second = std::forward<M>(value);
+      }
+      return result;
+    }
+
+    size_type erase(const K& key)
+    {
+      size_type i = find_index(key);
+      if (i == npos)
+      {
+        return 0;
+      }
+      erase_at(i);
+      return 1;
+    }
+
+    // invalidates all iterators: the next elements of the cluster may move into the erased slot
+    void erase(const_iterator pos)
+    {
+      erase_at(static_cast<size_type>(pos.group + pos.offset - ctrl));
+    }
+
+    void clear() noexcept
+    {
+      for (size_type i = 0; i < cap; ++i)
+      {
+        if (ctrl[i] != detail::kEmpty)
+        {
+          std::destroy_at(slots + i);
+          set_ctrl(i, detail::kEmpty);
+        }
+      }
+      sz = 0;
+    }
+
+    // make room for `n` elements without rehashing
+    void reserve(size_type n)
+    {
+      if (n > max_load(cap))
+      {
+        size_type new_cap = cap == 0 ? Group::kWidth : cap;
+        while (n > max_load(new_cap))
+        {
+          new_cap *= 2;
+        }
+        rehash(new_cap);
+      }
+    }
+
+   private:
+    static constexpr size_type npos = ~size_type{ 0 };
+
+    static size_type max_load(size_type capacity)
+    {
+      return capacity - capacity / 4;
+    }
+
+    size_type hash(const K& key) const
+    {
+      return detail::mix(static_cast<const Hash&>(*this)(key));
+    }
+    bool equal(const K& a, const K& b) const
+    {
+      return static_cast<const KeyEqual&>(*this)(a, b);
+    }
+    size_type home(size_type h) const
+    {
+      return (h >> 7U) & (cap - 1);
+    }
+    static ctrl_t tag(size_type h)
+    {
+      return static_cast<ctrl_t>(h & 0x7FU);
+    }
+
+    iterator iterator_at(size_type i)
+    {
+      return iterator(ctrl + i, slots + i, ctrl + cap);
+    }
+
+    // the first kWidth - 1 control bytes are mirrored after the last one, so that a group can be loaded at any position
+    void set_ctrl(size_type i, ctrl_t value)
+    {
+      ctrl[i] = value;
+      if (i < Group::kWidth - 1)
+      {
+        ctrl[cap + i] = value;
+      }
+    }
+
+    size_type find_index(const K& key) const
+    {
+      if (sz == 0)
+      {
+        return npos;
+      }
+      size_type h = hash(key);
+      size_type pos = home(h);
+      ctrl_t t = tag(h);
+      for (;;)
+      {
+        Group group(ctrl + pos);
+        for (std::uint32_t m = group.match(t); m != 0; m &= m - 1)
+        {
+          size_type i = (pos + static_cast<size_type>(__builtin_ctz(m))) & (cap - 1);
+          if (equal(slots[i].first, key))
+          {
+            return i;
+          }
+        }
+        // with linear probing and no tombstones, an element is never stored past the first empty slot after its home
+        if (group.match_empty() != 0)
+        {
+          return npos;
+        }
+        pos = (pos + Group::kWidth) & (cap - 1);
+      }
+    }
+
+    // the first empty slot from the home of `h`; there is always one since the load factor is at most 3/4
+    size_type find_empty(size_type h) const
+    {
+      size_type pos = home(h);
+      for (;;)
+      {
+        std::uint32_t m = Group(ctrl + pos).match_empty();
+        if (m != 0)
+        {
+          return (pos + static_cast<size_type>(__builtin_ctz(m))) & (cap - 1);
+        }
+        pos = (pos + Group::kWidth) & (cap - 1);
+      }
+    }
+
+    // construct a new element for `key`, which must not be in the table, and there must be room for it
+    template<typename... Args>
+    size_type insert_unique(const K& key, Args&&... args)
+    {
+      size_type h = hash(key);
+      size_type i = find_empty(h);
+      ::new (static_cast<void*>(slots + i)) value_type(std::forward<Args>(args)...);
+      set_ctrl(i, tag(h));
+      ++sz;
+      return i;
+    }
+
+    // backward shift deletion: walk the rest of the cluster and move back every element whose home is not between the hole
+    // and its current slot, so that every element stays reachable from its home without crossing an empty slot.
+    void erase_at(size_type hole)
+    {
+      std::destroy_at(slots + hole);
+      const size_type mask = cap - 1;
+      for (size_type j = (hole + 1) & mask; ctrl[j] != detail::kEmpty; j = (j + 1) & mask)
+      {
+        size_type h = home(hash(slots[j].first));
+        if (((j - h) & mask) >= ((j - hole) & mask))
+        {
+          ::new (static_cast<void*>(slots + hole)) value_type(std::move(slots[j]));
+          std::destroy_at(slots + j);
+          set_ctrl(hole, ctrl[j]);
+          hole = j;
+        }
+      }
+      set_ctrl(hole, detail::kEmpty);
+      --sz;
+    }
+
+    void rehash(size_type new_cap)
+    {
+      FlatHashMap table(static_cast<const Hash&>(*this), static_cast<const KeyEqual&>(*this), new_cap);
+      for (size_type i = 0; i < cap; ++i)
+      {
+        if (ctrl[i] != detail::kEmpty)
+        {
+          // copy instead of move if the move may throw, so that this table stays intact
+          table.insert_unique(slots[i].first, std::move_if_noexcept(slots[i]));
+        }
+      }
+      swap(table);
+    }
+
+    FlatHashMap(const Hash& hasher, const KeyEqual& key_equal, size_type capacity)
+        : Hash(hasher),
+          KeyEqual(key_equal),
+          ctrl(new ctrl_t[capacity + Group::kWidth - 1]),
+          cap(capacity)
+    {
+      std::fill_n(ctrl, capacity + Group::kWidth - 1, detail::kEmpty);
+      try
+      {
+        slots = std::allocator<value_type>().allocate(capacity);
+      }
+      catch (...)
+      {
+        delete[] ctrl;
+        throw;
+      }
+    }
+
+    void destroy_and_deallocate() noexcept
+    {
+      if (ctrl == nullptr)
+      {
+        return;
+      }
+      clear();
+      std::allocator<value_type>().deallocate(slots, cap);
+      delete[] ctrl;
+    }
+
+    ctrl_t* ctrl{};
+    value_type* slots{};
+    size_type sz{};
+    size_type cap{};
+  };
+}  // namespace mcpp
+
+#endif  // FLAT_HASH_MAP_H
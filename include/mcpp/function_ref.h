@@ -0,0 +1,49 @@
+#ifndef FUNCTION_REF_H
+#define FUNCTION_REF_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mcpp
+{
+  template<typename Signature>
+  class FunctionRef;
+
+  // A non-owning reference to a callable, in the spirit of llvm::function_ref and the proposed std::function_ref: a pointer
+  // to the callable and a pointer to a function that invokes it. Unlike std::function it never allocates and never copies
+  // the callable, so it is meant for parameters only: the callable must outlive the call it is passed to, which is always
+  // the case for a lambda written at the call site.
+  template<typename R, typename... Args>
+  class FunctionRef<R(Args...)>
+  {
+   public:
+    template<
+        typename Callable,
+        typename = std::enable_if_t<
+            !std::is_same<std::remove_cv_t<std::remove_reference_t<Callable>>, FunctionRef>::value &&
+            std::is_invocable_r<R, Callable&, Args...>::value>>
+    FunctionRef(Callable&& callable) noexcept  // NOLINT(google-explicit-constructor)
+        : object_(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+          invoke_(&invoke<std::remove_reference_t<Callable>>)
+    {
+    }
+
+    R operator()(Args... args) const
+    {
+      return invoke_(object_, std::forward<Args>(args)...);
+    }
+
+   private:
+    template<typename Callable>
+    static R invoke(void* object, Args... args)
+    {
+      return (*static_cast<Callable*>(object))(std::forward<Args>(args)...);
+    }
+
+    void* object_;
+    R (*invoke_)(void*, Args...);
+  };
+}  // namespace mcpp
+
+#endif  // FUNCTION_REF_H
@@ -0,0 +1,151 @@
+#ifndef HAZARD_POINTER_H
+#define HAZARD_POINTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mcpp
+{
+  // Hazard pointers (Michael, "Hazard pointers: safe memory reclamation for lock-free objects", 2004), with an interface
+  // close to the one of C++26 std::hazard_pointer.
+  //
+  // A reader publishes the address of the object it is about to access in a hazard slot, then checks that the object is
+  // still reachable; a writer that unlinks an object retires it instead of deleting it, and the object is deleted once no
+  // slot holds its address. Each thread keeps its retired objects in a thread-local list, and scans the slots once the list
+  // reaches twice the number of slots: a scan costs O(slots log slots) and frees at least half of the list, so reclamation
+  // is amortized constant time per retire, and at most O(slots) objects per thread wait to be freed.
+
+  struct HazardThreadState;
+
+  namespace detail
+  {
+    // the slots are never freed: a thread that exits leaves its slots inactive for others to take
+    struct alignas(64) HazardSlot
+    {
+      std::atomic<const void*> ptr{ nullptr };
+      std::atomic<bool> active{ false };
+      HazardSlot* next{ nullptr };  // the list of all the slots of the domain, only prepended to
+    };
+  }  // namespace detail
+
+  class HazardPointerDomain
+  {
+   public:
+    // the process-wide domain, never destroyed so that it outlives every thread and every static object using it
+    static HazardPointerDomain& global();
+
+    HazardPointerDomain(const HazardPointerDomain&) = delete;
+    HazardPointerDomain& operator=(const HazardPointerDomain&) = delete;
+
+    // Delete `ptr` with a default-constructed D once no hazard pointer protects it. `ptr` must be unlinked already: no
+    // thread may be able to reach it and protect it anew.
+    template<typename T, typename D = std::default_delete<T>>
+    void retire(T* ptr)
+    {
+      push_retired({ ptr, [](void* p) { D()(static_cast<T*>(p)); } });
+    }
+
+    // Scan now: free the retired objects of this thread, and those left behind by exited threads, that are not protected.
+    void reclaim();
+
+    std::size_t slot_count() const
+    {
+      return slot_count_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class HazardPointer;
+    friend struct HazardThreadState;
+
+    struct Retired
+    {
+      void* ptr;
+      void (*deleter)(void*);
+    };
+
+    HazardPointerDomain() = default;
+    ~HazardPointerDomain() = default;
+
+    detail::HazardSlot* acquire_slot();
+    void release_slot(detail::HazardSlot* slot);
+    void push_retired(Retired retired);
+    // free the retired objects of the thread (and the orphans) that no slot holds
+    void scan(HazardThreadState& state);
+
+    std::atomic<detail::HazardSlot*> slots_{ nullptr };
+    std::atomic<std::size_t> slot_count_{ 0 };
+    // the retired objects of the threads that exited, adopted by the next scan
+    std::mutex orphans_lock_;
+    std::vector<Retired> orphans_;
+  };
+
+  template<typename T, typename D = std::default_delete<T>>
+  void retire(T* ptr)
+  {
+    HazardPointerDomain::global().retire<T, D>(ptr);
+  }
+
+  // One hazard slot of the calling thread, for as long as the object lives. Creating and destroying one is cheap: the
+  // thread keeps a few free slots in thread-local storage.
+  class HazardPointer
+  {
+   public:
+    HazardPointer() : slot_(HazardPointerDomain::global().acquire_slot())
+    {
+    }
+
+    HazardPointer(const HazardPointer&) = delete;
+    HazardPointer& operator=(const HazardPointer&) = delete;
+
+    ~HazardPointer()
+    {
+      HazardPointerDomain::global().release_slot(slot_);
+    }
+
+    // Load `src` and protect the object it points to: the object cannot be freed until the protection is reset, or
+    // another object is protected.
+    template<typename T>
+    T* protect(const std::atomic<T*>& src)
+    {
+      T* ptr = src.load(std::memory_order_relaxed);
+      while (!try_protect(ptr, src))
+      {
+      }
+      return ptr;
+    }
+
+    // Protect `ptr`, which was loaded from `src`, if `src` still points to it. Otherwise `ptr` is set to the new value of
+    // `src`, and nothing is protected.
+    template<typename T>
+    bool try_protect(T*& ptr, const std::atomic<T*>& src)
+    {
+      T* expected = ptr;
+      // release: a scan that reads the new value also sees our accesses to the object the slot protected before, and may
+      // free that one
+      slot_->ptr.store(expected, std::memory_order_release);
+      // the store must be visible before src is read again, pairs with the fence of the scan: either the scan sees the
+      // slot, or we see that the object was unlinked
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      ptr = src.load(std::memory_order_acquire);
+      if (ptr != expected)
+      {
+        slot_->ptr.store(nullptr, std::memory_order_release);
+        return false;
+      }
+      return true;
+    }
+
+    void reset_protection()
+    {
+      slot_->ptr.store(nullptr, std::memory_order_release);
+    }
+
+   private:
+    detail::HazardSlot* slot_;
+  };
+}  // namespace mcpp
+
+#endif  // HAZARD_POINTER_H
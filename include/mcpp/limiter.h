@@ -0,0 +1,328 @@
+#ifndef LIMITER_H
+#define LIMITER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "mcpp/metrics.h"
+#include "mcpp/parking_primitives.h"
+#include "mcpp/spinlock.h"
+
+namespace mcpp
+{
+  /**
+    A fixed-size limiter: at most `max_size` requests between Request and Release at a time.
+
+    The free units are a Semaphore in one word: under the limit, Request is a CAS and Release a fetch_add, and only a
+    Request that finds no unit parks (in the ParkingLot, up to `request_timeout_ms`), and only a Release that finds a
+    thread parked calls into the ParkingLot to wake it up.
+  */
+  class FixedSizeLimiter
+  {
+   public:
+    FixedSizeLimiter() = default;
+    ~FixedSizeLimiter() = default;
+    explicit FixedSizeLimiter(uint32_t max_size, uint32_t request_timeout_ms)
+        : max_size_(max_size),
+          request_timeout_ms_(request_timeout_ms),
+          available_(max_size)
+    {
+    }
+
+    // 0 if the request was admitted, 1 if no unit was released within the timeout
+    int Request()
+    {
+      if (available_.try_acquire())
+      {
+        return 0;
+      }
+      auto timeout = Semaphore::Clock::now() + std::chrono::milliseconds(request_timeout_ms_);
+      return available_.try_acquire_until(timeout) ? 0 : 1;
+    }
+
+    void Release()
+    {
+      available_.release();
+    }
+
+    // the number of requests admitted and not released
+    uint32_t InUse() const
+    {
+      return max_size_ - available_.count();
+    }
+
+   private:
+    uint32_t max_size_ = 0;
+    uint32_t request_timeout_ms_ = 0;
+    Semaphore available_;
+  };
+
+  // Rate limiters that admit or reject without a lock: the state of each one is a few atomic words updated with a CAS,
+  // refilled lazily from the time of the request (steady_clock) instead of by a timer, and a rejection does not write, so
+  // an overloaded limiter does not bounce its cache line between the rejected threads. Each TryAcquire takes the time as
+  // an optional argument, for the tests and for the callers that already read the clock.
+
+  namespace detail
+  {
+    inline int64_t SinceEpochNs(std::chrono::steady_clock::time_point time)
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+  }  // namespace detail
+
+  /**
+    A token bucket of `burst` tokens, refilled at `rate` tokens per second, as the generic cell rate algorithm (GCRA): the
+    only state is the time at which the bucket will be full again (the theoretical arrival time, tat). Taking n tokens
+    pushes tat by n emission intervals (1 / rate) from max(tat, now), and is allowed as long as tat stays within `burst`
+    intervals from now. The interval is rounded to the nanosecond.
+  */
+  class TokenBucket
+  {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket(double rate, uint32_t burst)
+        : interval_ns_(std::max<int64_t>(1, static_cast<int64_t>(1e9 / rate))),
+          capacity_ns_(interval_ns_ * burst)
+    {
+    }
+
+    TokenBucket(const TokenBucket &) = delete;
+    TokenBucket &operator=(const TokenBucket &) = delete;
+
+    bool TryAcquire(uint32_t tokens = 1)
+    {
+      return TryAcquire(tokens, Clock::now());
+    }
+
+    bool TryAcquire(uint32_t tokens, Clock::time_point now)
+    {
+      const int64_t now_ns = detail::SinceEpochNs(now);
+      const int64_t cost = interval_ns_ * tokens;
+      int64_t tat = tat_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        const int64_t next = std::max(tat, now_ns) + cost;
+        if (next - now_ns > capacity_ns_)
+        {
+          return false;
+        }
+        if (tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+    }
+
+    // give back tokens taken by TryAcquire and not used: pulls tat back, never past the time the bucket was full
+    void Refund(uint32_t tokens)
+    {
+      tat_.fetch_sub(interval_ns_ * tokens, std::memory_order_relaxed);
+    }
+
+    // the number of tokens that can be taken at `now`
+    uint32_t Available(Clock::time_point now = Clock::now()) const
+    {
+      const int64_t now_ns = detail::SinceEpochNs(now);
+      const int64_t used = std::max<int64_t>(0, tat_.load(std::memory_order_relaxed) - now_ns);
+      return static_cast<uint32_t>((capacity_ns_ - std::min(used, capacity_ns_)) / interval_ns_);
+    }
+
+   private:
+    const int64_t interval_ns_;
+    const int64_t capacity_ns_;
+    // full at the epoch of the clock, so full from the start
+    alignas(kCacheLineSize) std::atomic<int64_t> tat_{ 0 };
+  };
+
+  /**
+    At most `limit` requests in any window of `window` length, approximated with two fixed windows (the sliding window
+    counter of Cloudflare): the count of the previous window, weighted by the part of it that is still inside the sliding
+    window, plus the count of the current one. Each window count is packed with the number of its window in one word, so a
+    thread that finds the word of a window past moves to the current window with the same CAS that counts its request.
+    A request whose time is older than a window the limiter already moved to (a stale `now`, or a thread preempted for
+    longer than a window) is rejected: the words never move back, or it would wipe the count of the newer window.
+
+    The words hold the low 32 bits of the window numbers, which wrap (after 49.7 days with 1 ms windows), so the stale
+    check compares with the full number of the newest window in a word of its own, `latest_`, moved forward before any
+    word moves to a new window. A 32-bit number that matches after an idle period of a multiple of 2^32 windows only
+    counts an old window in, which rejects more, never less.
+  */
+  class SlidingWindowLimiter
+  {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    SlidingWindowLimiter(uint32_t limit, Clock::duration window)
+        : limit_(limit),
+          window_ns_(std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(window).count()))
+    {
+    }
+
+    SlidingWindowLimiter(const SlidingWindowLimiter &) = delete;
+    SlidingWindowLimiter &operator=(const SlidingWindowLimiter &) = delete;
+
+    bool TryAcquire(uint32_t n = 1)
+    {
+      return TryAcquire(n, Clock::now());
+    }
+
+    bool TryAcquire(uint32_t n, Clock::time_point now)
+    {
+      const int64_t now_ns = detail::SinceEpochNs(now);
+      const auto window = static_cast<uint64_t>(now_ns / window_ns_);
+      const auto number = static_cast<uint32_t>(window);
+      // the part of the previous window that is still in the sliding window
+      const double previous_weight = 1 - static_cast<double>(now_ns % window_ns_) / static_cast<double>(window_ns_);
+      std::atomic<uint64_t> &current = windows_[window & 1];
+      uint64_t state = current.load(std::memory_order_acquire);
+      for (;;)
+      {
+        const uint64_t previous = windows_[(window + 1) & 1].load(std::memory_order_acquire);
+        // after the words: a word of a newer window was written after latest_ moved to it
+        if (latest_.load(std::memory_order_relaxed) > window)
+        {
+          return false;
+        }
+        const uint32_t count = Window(state) == number ? Count(state) : 0;
+        const uint32_t previous_count = Window(previous) == number - 1 ? Count(previous) : 0;
+        if (previous_count * previous_weight + count + n > limit_)
+        {
+          return false;
+        }
+        if (Window(state) != number)
+        {
+          MoveLatest(window);
+        }
+        if (current.compare_exchange_weak(state, Pack(number, count + n), std::memory_order_release,
+                                          std::memory_order_acquire))
+        {
+          return true;
+        }
+      }
+    }
+
+   private:
+    static uint64_t Pack(uint32_t window, uint32_t count)
+    {
+      return (uint64_t{ window } << 32) | count;
+    }
+
+    static uint32_t Window(uint64_t state)
+    {
+      return static_cast<uint32_t>(state >> 32);
+    }
+
+    static uint32_t Count(uint64_t state)
+    {
+      return static_cast<uint32_t>(state);
+    }
+
+    // once per window: only the first request of a window writes it
+    void MoveLatest(uint64_t window)
+    {
+      uint64_t latest = latest_.load(std::memory_order_relaxed);
+      while (latest < window && !latest_.compare_exchange_weak(latest, window, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    const uint32_t limit_;
+    const int64_t window_ns_;
+    // the windows of even and odd numbers and the newest window, all in one line: every request reads them
+    alignas(kCacheLineSize) std::atomic<uint64_t> windows_[2] = {};
+    std::atomic<uint64_t> latest_{ 0 };
+  };
+
+  /**
+    A token bucket split into `shards` buckets (at most `burst`), each with its share of the rate and of the burst. A
+    thread takes from the bucket of its shard (ThreadIndex), which only the threads of that shard write, and borrows from
+    the others, in order, when its own is short: the total rate and burst are the ones of a single bucket, but a shard that
+    idles lends its tokens instead of losing them. A request for more tokens than any one shard holds takes what each shard
+    has, in the same order, and refunds them all if the total falls short.
+  */
+  class ShardedTokenBucket
+  {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    ShardedTokenBucket(double rate, uint32_t burst, uint32_t shards = kMetricShards) : burst_(burst)
+    {
+      const uint32_t count = std::max(1U, std::min(shards, burst));
+      for (uint32_t i = 0; i < count; ++i)
+      {
+        buckets_.emplace_back(rate / count, burst / count + (i < burst % count ? 1 : 0));
+      }
+    }
+
+    bool TryAcquire(uint32_t tokens = 1)
+    {
+      return TryAcquire(tokens, Clock::now());
+    }
+
+    bool TryAcquire(uint32_t tokens, Clock::time_point now)
+    {
+      const auto count = static_cast<uint32_t>(buckets_.size());
+      const uint32_t local = detail::ThreadIndex() % count;
+      for (uint32_t i = 0; i < count; ++i)
+      {
+        if (buckets_[(local + i) % count].TryAcquire(tokens, now))
+        {
+          return true;
+        }
+      }
+      return tokens > 1 && tokens <= burst_ && TryAcquireAcross(tokens, now, local);
+    }
+
+    uint32_t Available(Clock::time_point now = Clock::now()) const
+    {
+      uint32_t available = 0;
+      for (const auto &bucket : buckets_)
+      {
+        available += bucket.Available(now);
+      }
+      return available;
+    }
+
+   private:
+    // the slow path, for the requests that no single shard can serve
+    bool TryAcquireAcross(uint32_t tokens, Clock::time_point now, uint32_t local)
+    {
+      const auto count = static_cast<uint32_t>(buckets_.size());
+      std::vector<uint32_t> taken(count, 0);
+      uint32_t left = tokens;
+      for (uint32_t i = 0; i < count && left > 0; ++i)
+      {
+        const uint32_t shard = (local + i) % count;
+        const uint32_t n = std::min(left, buckets_[shard].Available(now));
+        if (n > 0 && buckets_[shard].TryAcquire(n, now))
+        {
+          taken[shard] = n;
+          left -= n;
+        }
+      }
+      if (left == 0)
+      {
+        return true;
+      }
+      for (uint32_t shard = 0; shard < count; ++shard)
+      {
+        if (taken[shard] > 0)
+        {
+          buckets_[shard].Refund(taken[shard]);
+        }
+      }
+      return false;
+    }
+
+    const uint32_t burst_;
+    // a deque never moves its elements
+    std::deque<TokenBucket> buckets_;
+  };
+}  // namespace mcpp
+
+#endif  // LIMITER_H
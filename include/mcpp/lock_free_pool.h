@@ -0,0 +1,720 @@
+#ifndef LOCK_FREE_POOL_H
+#define LOCK_FREE_POOL_H
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/lockfree/queue.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mcpp/metrics.h"
+#include "mcpp/parking_primitives.h"
+#include "mcpp/spinlock.h"
+
+namespace mcpp
+{
+  struct LockFreePoolOptions
+  {
+    // the pool never evicts below min_size objs, and never creates more than max_size
+    uint32_t min_size = 0;
+    uint32_t max_size = 0;
+    // the number of objs created by the constructor, at least min_size
+    uint32_t prewarm = 0;
+    // an obj that stayed available that long is evicted, if the pool holds more objs than the demand
+    std::chrono::milliseconds idle_timeout{ 30 * 1000 };
+    // at least 1ms, and the idle timeout is rounded up to a whole number of intervals
+    std::chrono::milliseconds eviction_interval{ 1000 };
+    // the weight of the last eviction cycle in the demand, an EWMA of the peak number of leases per cycle
+    double demand_weight = 0.2;
+    // the number of returned objs each thread keeps for itself (at most 15), 0 to return all of them to the
+    // shared queue
+    uint32_t magazine_size = 8;
+    // time one checkout in that many per thread (0: none), and record its wait and lease latencies in the histograms of
+    // the metrics: three reads of the clock per timed checkout and return
+    uint32_t latency_sample_period = 16;
+  };
+
+  // A snapshot of the metrics of a LockFreePool, taken while it runs: the counters are totals since its creation, and two
+  // snapshots give the rates in between.
+  struct LockFreePoolMetrics
+  {
+    std::chrono::steady_clock::time_point time;
+
+    // the objs created and not evicted, the ones in the shared queue, and the others (leased, or cached by a thread)
+    uint32_t size = 0;
+    uint32_t available = 0;
+    uint32_t leased = 0;
+    uint32_t max_size = 0;
+    double demand = 0;
+
+    uint64_t checkouts = 0;
+    // the checkouts served by the magazine of the thread
+    uint64_t magazine_hits = 0;
+    // the checkouts that had to wait for an obj to be returned, and the GetFor that gave up
+    uint64_t waits = 0;
+    uint64_t timeouts = 0;
+    uint64_t creations = 0;
+    uint64_t evictions = 0;
+
+    // in nanoseconds, of the timed checkouts (see latency_sample_period): the time spent in Getobj/TryGet/GetFor until an
+    // obj was found, and the time from checkout to return
+    HistogramSnapshot wait_ns;
+    HistogramSnapshot lease_ns;
+
+    double Utilization() const
+    {
+      return max_size == 0 ? 0 : static_cast<double>(leased) / max_size;
+    }
+
+    // per second, since `before`
+    double CheckoutRate(const LockFreePoolMetrics &before) const
+    {
+      return Rate(checkouts - before.checkouts, before);
+    }
+
+    double CreationRate(const LockFreePoolMetrics &before) const
+    {
+      return Rate(creations - before.creations, before);
+    }
+
+    double EvictionRate(const LockFreePoolMetrics &before) const
+    {
+      return Rate(evictions - before.evictions, before);
+    }
+
+   private:
+    double Rate(uint64_t delta, const LockFreePoolMetrics &before) const
+    {
+      const std::chrono::duration<double> elapsed = time - before.time;
+      return elapsed.count() > 0 ? static_cast<double>(delta) / elapsed.count() : 0;
+    }
+  };
+
+  /**
+    A pool of up to `size` objects, created on demand by `initializer`.
+
+    reference:
+    https://stackoverflow.com/questions/43540943/using-boost-lockfree-queue-is-slower-than-using-mutexes
+    https://blog.afach.de/?p=825
+
+    A Semaphore counts the objects a caller may take right now: the idle ones in `available_objs_queue_` plus the ones
+    that can still be created. A caller takes a unit first, then pops an idle object or creates one, and a returned object
+    is pushed before its unit is released. So holding a unit guarantees an object, and a caller that finds the pool
+    exhausted parks in the ParkingLot until exactly one object comes back, instead of polling the queue.
+
+    The pool shrinks from a background thread (StartEvictionThread), not on checkout or return: see Evict.
+
+    In front of the shared queue, each thread keeps the last few objs it returned in a magazine of its own (Bonwick and
+    Adams, "Magazines and Vmem", 2001), outside of the count of the Semaphore: a checkout that follows a return on the
+    same thread takes the obj back from there, and touches no shared cache line. A full magazine gives half of its objs
+    back to the queue at once. The threads share kMagazineCount magazines, each with a lock that its own thread takes
+    almost always uncontended. A caller about to wait for an obj announces itself in `waiters_`, then drains all the
+    magazines; a thread that returns an obj to its magazine checks `waiters_` afterwards, and drains its magazine too if
+    someone waits, so no obj stays hidden in a magazine while a caller waits.
+  */
+  template<typename T>
+  class LockFreePool
+  {
+   public:
+    // A lease on one pooled object: it refers to the object in its slot, and returns the slot to the pool when it is
+    // destroyed or reset. Movable, and empty once moved from, or when TryGet/GetFor found no object.
+    class Lease
+    {
+     public:
+      Lease() = default;
+      Lease(const Lease &) = delete;
+      Lease &operator=(const Lease &) = delete;
+
+      Lease(Lease &&other) noexcept
+          : obj_(std::exchange(other.obj_, nullptr)),
+            obj_idx_(other.obj_idx_),
+            pool_ptr_(other.pool_ptr_),
+            start_(other.start_)
+      {
+      }
+
+      Lease &operator=(Lease &&other) noexcept
+      {
+        if (this != &other)
+        {
+          reset();
+          obj_ = std::exchange(other.obj_, nullptr);
+          obj_idx_ = other.obj_idx_;
+          pool_ptr_ = other.pool_ptr_;
+          start_ = other.start_;
+        }
+        return *this;
+      }
+
+      ~Lease()
+      {
+        reset();
+      }
+
+      void reset()
+      {
+        if (obj_ != nullptr)
+        {
+          obj_ = nullptr;
+          pool_ptr_->Return(obj_idx_, start_);
+        }
+      }
+
+      explicit operator bool() const
+      {
+        return obj_ != nullptr;
+      }
+
+      T &operator*() const
+      {
+        return *obj_;
+      }
+
+      T *operator->() const
+      {
+        return obj_;
+      }
+
+      T *get() const
+      {
+        return obj_;
+      }
+
+     private:
+      friend class LockFreePool;
+
+      Lease(T *obj, uint32_t obj_idx, LockFreePool *pool_ptr, Semaphore::Clock::time_point start)
+          : obj_(obj),
+            obj_idx_(obj_idx),
+            pool_ptr_(pool_ptr),
+            start_(start)
+      {
+      }
+
+      T *obj_ = nullptr;
+      uint32_t obj_idx_ = 0;
+      LockFreePool *pool_ptr_ = nullptr;
+      // the time of the checkout if it is timed, the epoch of the clock otherwise
+      Semaphore::Clock::time_point start_;
+    };
+
+    using Clock = Semaphore::Clock;
+
+    LockFreePool(const LockFreePoolOptions &options, std::function<T()> initializer)
+        : options_(Sanitize(options)),
+          objs_pool_(options_.max_size),
+          last_returned_(new std::atomic<uint64_t>[options_.max_size]),
+          obj_initializer_(std::move(initializer)),
+          available_objs_queue_(options_.max_size),
+          permits_(options_.max_size),
+          idle_ticks_(IdleTicks(options_)),
+          magazines_(options_.magazine_size > 0 ? new Magazine[kMagazineCount] : nullptr)
+    {
+      for (uint32_t i = 0; i < options_.max_size; i++)
+      {
+        free_obj_indexes_.push_back(i);
+        last_returned_[i].store(0, std::memory_order_relaxed);
+      }
+      std::reverse(free_obj_indexes_.begin(), free_obj_indexes_.end());
+      // create the first objs now, so that the first burst does not wait for them
+      for (uint32_t i = 0; i < options_.prewarm; i++)
+      {
+        auto idx = free_obj_indexes_.back();
+        free_obj_indexes_.pop_back();
+        objs_pool_[idx].emplace(obj_initializer_());
+        total_objs_cnt_++;
+        available_objs_cnt_++;
+        creations_.Add();
+        available_objs_queue_.push(idx);
+      }
+    }
+
+    LockFreePool(uint32_t size, std::function<T()> initializer)
+        : LockFreePool(LockFreePoolOptions{ 0, size }, std::move(initializer))
+    {
+    }
+
+    LockFreePool() = delete;
+    LockFreePool(const LockFreePool &) = delete;
+    LockFreePool &operator=(const LockFreePool &) = delete;
+    LockFreePool(LockFreePool &&) = delete;
+    LockFreePool &operator=(LockFreePool &&) = delete;
+
+    ~LockFreePool()
+    {
+      shutdown_.set();
+      if (eviction_thread_.joinable())
+      {
+        eviction_thread_.join();
+      }
+      available_objs_queue_.consume_all([](uint32_t &) {});
+      objs_pool_.clear();
+    }
+
+    /**
+      Get an available obj, or create a new one if none exists, or wait until one is returned.
+
+      The returned `obj` will automatically push back obj index to
+      `objPool` when it goes out of scope, so that `available_objs_queue_`
+      could get an available obj.
+
+      Note: `Getobj` first takes the obj this thread returned last from its
+      magazine (LIFO, the most likely to be in the cache), and only then pops
+      the oldest idle obj from the shared queue (FIFO) or creates one. So a
+      thread that returns and takes objs in a loop reuses the same few objs,
+      and the others stay idle in the queue until eviction.
+    */
+    Lease Getobj()
+    {
+      const auto start = SampleStart();
+      uint32_t obj_idx = 0;
+      if (TakeFromMagazine(obj_idx))
+      {
+        return MakeLease(obj_idx, start);
+      }
+      if (!permits_.try_acquire())
+      {
+        StartWaiting();
+        permits_.acquire();
+        waiters_.fetch_sub(1);
+      }
+      return Checkout(start);
+    }
+
+    // Get an obj only if one is idle or can be created right away, otherwise an empty lease.
+    Lease TryGet()
+    {
+      const auto start = SampleStart();
+      uint32_t obj_idx = 0;
+      if (TakeFromMagazine(obj_idx))
+      {
+        return MakeLease(obj_idx, start);
+      }
+      if (permits_.try_acquire())
+      {
+        return Checkout(start);
+      }
+      // the idle objs may all be in the magazines of other threads
+      Drain();
+      return permits_.try_acquire() ? Checkout(start) : Lease();
+    }
+
+    // Get an obj, waiting at most `timeout` for one to be returned, otherwise an empty lease.
+    template<typename Rep, typename Period>
+    Lease GetFor(std::chrono::duration<Rep, Period> timeout)
+    {
+      const auto deadline = Clock::now() + timeout;
+      const auto start = SampleStart();
+      uint32_t obj_idx = 0;
+      if (TakeFromMagazine(obj_idx))
+      {
+        return MakeLease(obj_idx, start);
+      }
+      if (!permits_.try_acquire())
+      {
+        StartWaiting();
+        const bool acquired = permits_.try_acquire_until(deadline);
+        waiters_.fetch_sub(1);
+        if (!acquired)
+        {
+          timeouts_.Add();
+          return Lease();
+        }
+      }
+      return Checkout(start);
+    }
+
+    // Run Evict every `eviction_interval`, until the pool is destroyed.
+    void StartEvictionThread()
+    {
+      eviction_thread_ = std::thread(
+          [this]()
+          {
+            pthread_setname_np(pthread_self(), "objPoolEvictionThread");
+            while (!shutdown_.wait_until(Clock::now() + options_.eviction_interval))
+            {
+              Evict();
+            }
+          });
+    }
+
+    /**
+      One eviction cycle, the clock of the idle times: fold the peak number of leases since the last cycle into the
+      demand, then evict the objs above max(demand, min_size) that have been idle for `idle_timeout`, all at once.
+
+      `available_objs_queue_` is FIFO, so its head holds the objs returned the longest time ago: the cycle pops from the
+      head and stops at the first obj that is not idle. Returns the number of objs evicted. Not to be called concurrently
+      with itself, or with a running eviction thread.
+    */
+    uint32_t Evict()
+    {
+      // the objs cached by the threads age in the queue like the others
+      Drain();
+      const uint64_t tick = tick_.fetch_add(1, std::memory_order_relaxed) + 1;
+      const uint32_t peak = peak_leased_.exchange(Leased(), std::memory_order_relaxed);
+      const double demand =
+          options_.demand_weight * peak + (1 - options_.demand_weight) * demand_.load(std::memory_order_relaxed);
+      demand_.store(demand, std::memory_order_relaxed);
+      const auto target = std::clamp(static_cast<uint32_t>(std::lround(demand)), options_.min_size, options_.max_size);
+
+      // hold a unit for each obj out of the queue, so that no caller counts on it
+      std::vector<uint32_t> evicted;
+      while (total_objs_cnt_.load() - static_cast<uint32_t>(evicted.size()) > target && permits_.try_acquire())
+      {
+        uint32_t obj_idx = 0;
+        if (!available_objs_queue_.pop(obj_idx))
+        {
+          permits_.release();
+          break;
+        }
+        if (tick - last_returned_[obj_idx].load(std::memory_order_relaxed) <= idle_ticks_)
+        {
+          // put it back as it was, at the tail
+          available_objs_queue_.push(obj_idx);
+          permits_.release();
+          break;
+        }
+        available_objs_cnt_--;
+        // nobody else can reach the obj now: close it outside of the lock
+        objs_pool_[obj_idx].reset();
+        evicted.push_back(obj_idx);
+      }
+      if (evicted.empty())
+      {
+        return 0;
+      }
+      {
+        std::unique_lock<std::mutex> lock_guard(mutex_);
+        free_obj_indexes_.insert(free_obj_indexes_.end(), evicted.begin(), evicted.end());
+        total_objs_cnt_ -= static_cast<uint32_t>(evicted.size());
+      }
+      evictions_.Add(evicted.size());
+      permits_.release(static_cast<uint32_t>(evicted.size()));
+      return static_cast<uint32_t>(evicted.size());
+    }
+
+    // the number of objs created and not evicted
+    uint32_t Size() const
+    {
+      return total_objs_cnt_.load();
+    }
+
+    uint32_t Available() const
+    {
+      return available_objs_cnt_.load();
+    }
+
+    // the smoothed peak number of leases per eviction cycle
+    double Demand() const
+    {
+      return demand_.load(std::memory_order_relaxed);
+    }
+
+    LockFreePoolMetrics Metrics() const
+    {
+      LockFreePoolMetrics metrics;
+      metrics.time = Clock::now();
+      metrics.size = Size();
+      metrics.available = Available();
+      metrics.leased = Leased();
+      metrics.max_size = options_.max_size;
+      metrics.demand = Demand();
+      metrics.checkouts = checkouts_.Sum();
+      metrics.magazine_hits = magazine_hits_.Sum();
+      metrics.waits = waits_.Sum();
+      metrics.timeouts = timeouts_.Sum();
+      metrics.creations = creations_.Sum();
+      metrics.evictions = evictions_.Sum();
+      if (options_.latency_sample_period != 0)
+      {
+        metrics.wait_ns = wait_ns_.Snapshot();
+        metrics.lease_ns = lease_ns_.Snapshot();
+      }
+      return metrics;
+    }
+
+   protected:
+    static constexpr uint32_t kMagazineCount = 64;
+    static constexpr uint32_t kMaxMagazineSize = 15;
+
+    // the lock and the objs in two cache lines of their own: only its thread touches them, most of the time
+    struct Magazine
+    {
+      TTASLock lock;
+      uint32_t count = 0;
+      std::array<uint32_t, kMaxMagazineSize> objs;
+    };
+
+    static LockFreePoolOptions Sanitize(LockFreePoolOptions options)
+    {
+      options.min_size = std::min(options.min_size, options.max_size);
+      options.prewarm = std::clamp(options.prewarm, options.min_size, options.max_size);
+      options.eviction_interval = std::max(options.eviction_interval, std::chrono::milliseconds(1));
+      options.demand_weight = std::clamp(options.demand_weight, 0.0, 1.0);
+      options.magazine_size = std::min(options.magazine_size, kMaxMagazineSize);
+      return options;
+    }
+
+    // idle_timeout in eviction cycles, rounded up: an obj returned just before a cycle is not idle yet
+    static uint64_t IdleTicks(const LockFreePoolOptions &options)
+    {
+      const auto interval = options.eviction_interval;
+      return static_cast<uint64_t>((options.idle_timeout + interval - std::chrono::milliseconds(1)) / interval);
+    }
+
+    Lease Checkout(Clock::time_point start)
+    {
+      uint32_t obj_idx = Take();
+      // a new peak is rare: the load alone, most of the time
+      const uint32_t leased = Leased();
+      uint32_t peak = peak_leased_.load(std::memory_order_relaxed);
+      while (leased > peak && !peak_leased_.compare_exchange_weak(peak, leased, std::memory_order_relaxed))
+      {
+      }
+      return MakeLease(obj_idx, start);
+    }
+
+    Lease MakeLease(uint32_t obj_idx, Clock::time_point start)
+    {
+      checkouts_.Add();
+      if (start != Clock::time_point())
+      {
+        const auto now = Clock::now();
+        wait_ns_.Record(Nanoseconds(now - start));
+        start = now;
+      }
+      return Lease(&*objs_pool_[obj_idx], obj_idx, this, start);
+    }
+
+    // the time if the checkout is to be timed, the epoch of the clock otherwise
+    Clock::time_point SampleStart() const
+    {
+      if (options_.latency_sample_period == 0)
+      {
+        return Clock::time_point();
+      }
+      thread_local uint32_t checkouts = 0;
+      return ++checkouts % options_.latency_sample_period == 0 ? Clock::now() : Clock::time_point();
+    }
+
+    static uint64_t Nanoseconds(Clock::duration duration)
+    {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    // With a unit of `permits_` held: pop an idle obj, or create one. Either must succeed, but a returned obj and a free
+    // index can swap places under us (we miss the obj, another caller takes the last free index), so retry until one does.
+    // If the initializer throws, the unit and the free index go back to the pool before the exception propagates.
+    uint32_t Take()
+    {
+      for (;;)
+      {
+        uint32_t obj_idx = 0;
+        if (available_objs_queue_.pop(obj_idx))
+        {
+          available_objs_cnt_--;
+          return obj_idx;
+        }
+        // guarantee `total_objs_cnt_ < max_size` is safe in concurrent cases.
+        std::unique_lock<std::mutex> lock_guard(mutex_);
+        if (total_objs_cnt_ < options_.max_size)
+        {
+          // create the obj in a free idx, and pop the idx only once the obj exists
+          auto idx = free_obj_indexes_.back();
+          try
+          {
+            objs_pool_[idx].emplace(obj_initializer_());
+          }
+          catch (...)
+          {
+            lock_guard.unlock();
+            permits_.release();
+            throw;
+          }
+          free_obj_indexes_.pop_back();
+          total_objs_cnt_++;
+          creations_.Add();
+          return idx;
+        }
+      }
+    }
+
+    void Return(uint32_t obj_idx, Clock::time_point start)
+    {
+      if (start != Clock::time_point())
+      {
+        lease_ns_.Record(Nanoseconds(Clock::now() - start));
+      }
+      if (options_.magazine_size == 0)
+      {
+        Release(&obj_idx, 1);
+        return;
+      }
+      Magazine &magazine = magazines_[detail::ThreadIndex() % kMagazineCount];
+      std::array<uint32_t, kMaxMagazineSize> batch;
+      uint32_t batch_size = 0;
+      {
+        std::lock_guard<TTASLock> guard(magazine.lock);
+        if (magazine.count == options_.magazine_size)
+        {
+          // full: the oldest half goes back to the queue, in one release of the Semaphore
+          batch_size = (options_.magazine_size + 1) / 2;
+          std::copy(magazine.objs.begin(), magazine.objs.begin() + batch_size, batch.begin());
+          std::copy(magazine.objs.begin() + batch_size, magazine.objs.begin() + magazine.count, magazine.objs.begin());
+          magazine.count -= batch_size;
+        }
+        magazine.objs[magazine.count++] = obj_idx;
+      }
+      if (batch_size > 0)
+      {
+        Release(batch.data(), batch_size);
+      }
+      // pairs with StartWaiting: either the waiter sees our obj when it drains, or we see the waiter
+      if (waiters_.load() != 0)
+      {
+        Flush(magazine);
+      }
+    }
+
+    // push the indexes before releasing their units, so that the callers that take the units find them
+    void Release(const uint32_t *obj_idxs, uint32_t n)
+    {
+      const uint64_t tick = tick_.load(std::memory_order_relaxed);
+      for (uint32_t i = 0; i < n; i++)
+      {
+        last_returned_[obj_idxs[i]].store(tick, std::memory_order_relaxed);
+        available_objs_queue_.push(obj_idxs[i]);
+      }
+      available_objs_cnt_ += n;
+      permits_.release(n);
+    }
+
+    bool TakeFromMagazine(uint32_t &obj_idx)
+    {
+      if (options_.magazine_size == 0)
+      {
+        return false;
+      }
+      Magazine &magazine = magazines_[detail::ThreadIndex() % kMagazineCount];
+      std::lock_guard<TTASLock> guard(magazine.lock);
+      if (magazine.count == 0)
+      {
+        return false;
+      }
+      // the last one returned, the most likely to be in the cache
+      obj_idx = magazine.objs[--magazine.count];
+      magazine_hits_.Add();
+      return true;
+    }
+
+    void Flush(Magazine &magazine)
+    {
+      std::array<uint32_t, kMaxMagazineSize> batch;
+      uint32_t batch_size = 0;
+      {
+        std::lock_guard<TTASLock> guard(magazine.lock);
+        batch_size = magazine.count;
+        std::copy(magazine.objs.begin(), magazine.objs.begin() + batch_size, batch.begin());
+        magazine.count = 0;
+      }
+      if (batch_size > 0)
+      {
+        Release(batch.data(), batch_size);
+      }
+    }
+
+    // give the objs of all the magazines back to the queue
+    void Drain()
+    {
+      if (options_.magazine_size == 0)
+      {
+        return;
+      }
+      for (uint32_t i = 0; i < kMagazineCount; i++)
+      {
+        Flush(magazines_[i]);
+      }
+    }
+
+    void StartWaiting()
+    {
+      waits_.Add();
+      waiters_.fetch_add(1);
+      Drain();
+    }
+
+    // objs in the magazines count as leased: they are kept for their threads
+    uint32_t Leased() const
+    {
+      const uint32_t total = total_objs_cnt_.load(std::memory_order_relaxed);
+      const uint32_t available = available_objs_cnt_.load(std::memory_order_relaxed);
+      return total > available ? total - available : 0;
+    }
+
+    const LockFreePoolOptions options_;
+    // the objs in place, empty until created and once evicted
+    std::vector<std::optional<T>> objs_pool_;
+    // the eviction tick of the last return of each obj
+    std::unique_ptr<std::atomic<uint64_t>[]> last_returned_;
+
+    // track free obj indexes for creating new obj, and the num is also the real
+    // obj index in `objs_` vector.
+    std::vector<uint32_t> free_obj_indexes_;
+
+    // obj initializer to create new obj object.
+    std::function<T()> obj_initializer_;
+
+    // available obj index queue used for geting a available obj in concurrent.
+    boost::lockfree::queue<uint32_t, boost::lockfree::fixed_sized<true>> available_objs_queue_;
+
+    // the number of objs that can be taken without waiting: available ones, plus the ones that can still be created
+    Semaphore permits_;
+
+    // the available obj count of the current pool.
+    std::atomic_uint32_t available_objs_cnt_ = 0;
+
+    // track the total obj count of the current pool.
+    std::atomic_uint32_t total_objs_cnt_ = 0;
+
+    // a mutex to protect `free_obj_indexes_` and the creation of new objs.
+    std::mutex mutex_;
+
+    // the number of eviction cycles so far: a coarse clock, so that a return does not read the time
+    std::atomic<uint64_t> tick_{ 0 };
+    const uint64_t idle_ticks_;
+    // the highest number of leases since the last eviction cycle
+    std::atomic<uint32_t> peak_leased_{ 0 };
+    // only written by the eviction cycles
+    std::atomic<double> demand_{ 0 };
+
+    Event shutdown_;
+    std::thread eviction_thread_;
+
+    // the number of callers that wait for an obj, which must not be kept in a magazine
+    std::atomic<uint32_t> waiters_{ 0 };
+    // empty if the magazine size is 0
+    std::unique_ptr<Magazine[]> magazines_;
+
+    ShardedCounter checkouts_;
+    ShardedCounter magazine_hits_;
+    ShardedCounter waits_;
+    ShardedCounter timeouts_;
+    ShardedCounter creations_;
+    ShardedCounter evictions_;
+    LatencyHistogram wait_ns_;
+    LatencyHistogram lease_ns_;
+  };
+}  // namespace mcpp
+
+#endif  // LOCK_FREE_POOL_H
@@ -0,0 +1,178 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mcpp/spinlock.h"
+
+namespace mcpp
+{
+  // Metrics that many threads update on their hot paths, and that a monitoring thread reads at any time without stopping
+  // them. Each thread updates a shard of its own (ThreadIndex() % kMetricShards, one cache line per shard) with relaxed
+  // atomics, and a read sums the shards: the counts are exact once the updates stop, and may lag by the updates in flight
+  // while they run.
+
+  constexpr std::size_t kMetricShards = 8;
+
+  namespace detail
+  {
+    // a small index per thread, to pick its shard of a per-thread structure
+    inline uint32_t ThreadIndex()
+    {
+      static std::atomic<uint32_t> next{ 0 };
+      thread_local const uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+      return index;
+    }
+  }  // namespace detail
+
+  class ShardedCounter
+  {
+   public:
+    void Add(uint64_t n = 1)
+    {
+      shards_[detail::ThreadIndex() % kMetricShards].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t Sum() const
+    {
+      uint64_t sum = 0;
+      for (const auto &shard : shards_)
+      {
+        sum += shard.value.load(std::memory_order_relaxed);
+      }
+      return sum;
+    }
+
+   private:
+    struct alignas(kCacheLineSize) Shard
+    {
+      std::atomic<uint64_t> value{ 0 };
+    };
+
+    std::array<Shard, kMetricShards> shards_;
+  };
+
+  // A copy of the buckets of a LatencyHistogram.
+  struct HistogramSnapshot
+  {
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    double Mean() const
+    {
+      return count == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+
+    // The upper bound of the bucket of the value at `quantile` (0 to 1): within 12.5% of the value, never below it.
+    uint64_t Percentile(double quantile) const;
+  };
+
+  // A histogram of non-negative values (e.g. latencies in nanoseconds) with the layout of HdrHistogram: each power of two
+  // is split into kSubBuckets linear buckets, so the relative error is at most 1 / kSubBuckets over the whole range, with a
+  // fixed number of buckets and no allocation when recording. The values below kSubBuckets have a bucket each, the values
+  // from 2^kMaxMagnitude on share the last power of two.
+  class LatencyHistogram
+  {
+   public:
+    static constexpr uint32_t kSubBucketBits = 3;
+    static constexpr uint32_t kSubBuckets = 1U << kSubBucketBits;
+    static constexpr uint32_t kMaxMagnitude = 47;  // 2^47 ns: 39 hours
+    static constexpr uint32_t kBuckets = (kMaxMagnitude - kSubBucketBits + 2) * kSubBuckets;
+
+    static uint32_t BucketIndex(uint64_t value)
+    {
+      if (value < kSubBuckets)
+      {
+        return static_cast<uint32_t>(value);
+      }
+      auto magnitude = static_cast<uint32_t>(63 - __builtin_clzll(value));
+      if (magnitude > kMaxMagnitude)
+      {
+        return kBuckets - 1;
+      }
+      // the kSubBucketBits bits below the leading one
+      auto sub_bucket = static_cast<uint32_t>(value >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1);
+      return (magnitude - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+    }
+
+    // the highest value of the bucket
+    static uint64_t BucketUpperBound(uint32_t index)
+    {
+      if (index < kSubBuckets)
+      {
+        return index;
+      }
+      const uint32_t magnitude = index / kSubBuckets + kSubBucketBits - 1;
+      const uint64_t width = uint64_t{ 1 } << (magnitude - kSubBucketBits);
+      return (kSubBuckets + index % kSubBuckets) * width + width - 1;
+    }
+
+    void Record(uint64_t value)
+    {
+      Shard &shard = shards_[detail::ThreadIndex() % kMetricShards];
+      shard.counts[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+      shard.sum.fetch_add(value, std::memory_order_relaxed);
+      uint64_t max = shard.max.load(std::memory_order_relaxed);
+      while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    HistogramSnapshot Snapshot() const
+    {
+      HistogramSnapshot snapshot;
+      snapshot.counts.assign(kBuckets, 0);
+      for (const auto &shard : shards_)
+      {
+        for (uint32_t i = 0; i < kBuckets; ++i)
+        {
+          const uint64_t count = shard.counts[i].load(std::memory_order_relaxed);
+          snapshot.counts[i] += count;
+          snapshot.count += count;
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+      }
+      return snapshot;
+    }
+
+   private:
+    struct alignas(kCacheLineSize) Shard
+    {
+      std::array<std::atomic<uint64_t>, kBuckets> counts{};
+      std::atomic<uint64_t> sum{ 0 };
+      std::atomic<uint64_t> max{ 0 };
+    };
+
+    std::array<Shard, kMetricShards> shards_;
+  };
+
+  inline uint64_t HistogramSnapshot::Percentile(double quantile) const
+  {
+    if (count == 0)
+    {
+      return 0;
+    }
+    // the rank of the value, from 1 to count
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * static_cast<double>(count) + 0.5));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < counts.size(); ++i)
+    {
+      seen += counts[i];
+      if (seen >= rank)
+      {
+        return std::min(LatencyHistogram::BucketUpperBound(i), max);
+      }
+    }
+    return max;
+  }
+}  // namespace mcpp
+
+#endif  // METRICS_H
@@ -0,0 +1,273 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mcpp
+{
+  // A pool of fixed-size blocks for node-based containers (std::list, std::forward_list, std::map, ...).
+  //
+  // Blocks are carved from large slabs in address order, so nodes allocated one after another are neighbours in memory,
+  // like the elements of a vector, instead of being scattered across the heap between unrelated malloc calls.
+  //
+  // Every thread pops and pushes blocks on its own free list without any lock, and moves blocks from and to the pool by
+  // batches of kBatchBlocks under the pool mutex. An empty free list takes a batch of the blocks given back by the other
+  // threads, or carves the next batch from the current slab (the slab size doubles, up to kMaxSlabBytes). A block may be
+  // freed by another thread than the one that allocated it: it joins the free list of the freeing thread, which gives a
+  // batch back to the pool past kMaxLocalBlocks, so a producer/consumer pair recycles the same blocks instead of growing.
+  // An exiting thread gives all of its free list back, and the blocks it frees afterwards one by one.
+  //
+  // Slabs are never returned to the system, and the pool itself is never destroyed, so that the containers destroyed at
+  // exit (statics, thread_locals) can still free their nodes into it: the pool is meant for containers that are rebuilt
+  // over and over with a similar peak size, not to give memory back after a one-off peak.
+  template<std::size_t Size, std::size_t Align>
+  class NodePool
+  {
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+   public:
+    static constexpr std::size_t kAlign = std::max(Align, alignof(FreeBlock));
+    static constexpr std::size_t kBlockSize = (std::max(Size, sizeof(FreeBlock)) + kAlign - 1) / kAlign * kAlign;
+    static constexpr std::size_t kMinSlabBlocks = 32;
+    static constexpr std::size_t kMaxSlabBytes = std::size_t{ 1 } << 20U;
+    static constexpr std::size_t kBatchBlocks = 64;
+    static constexpr std::size_t kMaxLocalBlocks = 2 * kBatchBlocks;
+
+    static void* allocate()
+    {
+      Local& local = local_list();
+      if (local.head == nullptr)
+      {
+        refill(local);
+      }
+      FreeBlock* block = local.head;
+      local.head = block->next;
+      --local.count;
+      if (local.flushed)
+      {
+        give_back(local, local.count);
+      }
+      return block;
+    }
+
+    static void deallocate(void* p) noexcept
+    {
+      Local& local = local_list();
+      auto* block = static_cast<FreeBlock*>(p);
+      block->next = local.head;
+      local.head = block;
+      ++local.count;
+      if (local.flushed)
+      {
+        give_back(local, local.count);
+      }
+      else if (local.count > kMaxLocalBlocks)
+      {
+        give_back(local, kBatchBlocks);
+      }
+    }
+
+    // number of slabs allocated so far by all threads
+    static std::size_t slab_count()
+    {
+      Global& g = global();
+      std::lock_guard<std::mutex> lock(g.mutex);
+      return g.slabs.size();
+    }
+
+   private:
+    struct Global
+    {
+      std::mutex mutex;
+      FreeBlock* returned{};  // blocks given back by the threads
+      std::size_t returned_count{};
+      std::byte* carve{};  // the blocks of the last slab that no thread took yet
+      std::byte* carve_end{};
+      std::size_t next_slab_blocks{ kMinSlabBlocks };
+      std::vector<void*> slabs;
+    };
+
+    // trivially destructible, so that it stays usable until the thread ends, e.g. from the destructor of another
+    // thread_local that owns a container
+    struct Local
+    {
+      FreeBlock* head{};
+      std::size_t count{};
+      // the thread is exiting: the blocks freed from now on (by the thread_locals constructed before the first allocation
+      // of the thread, or by the statics destroyed by the main thread) go straight back to the pool
+      bool flushed{};
+    };
+
+    // gives the free list of an exiting thread back to the pool
+    struct Flusher
+    {
+      Local* local;
+
+      explicit Flusher(Local* l) : local(l)
+      {
+      }
+      Flusher(const Flusher&) = delete;
+      Flusher& operator=(const Flusher&) = delete;
+      ~Flusher()
+      {
+        give_back(*local, local->count);
+        local->flushed = true;
+      }
+    };
+
+    // never destroyed, see above
+    static Global& global()
+    {
+      static Global& g = *new Global;
+      return g;
+    }
+
+    static Local& local_list()
+    {
+      thread_local Local local;
+      thread_local Flusher flusher{ &local };
+      return local;
+    }
+
+    // move the first `n` blocks of the free list of `local` (at most count) to the pool
+    static void give_back(Local& local, std::size_t n) noexcept
+    {
+      if (n == 0)
+      {
+        return;
+      }
+      FreeBlock* head = local.head;
+      FreeBlock* tail = head;
+      for (std::size_t i = 1; i < n; ++i)
+      {
+        tail = tail->next;
+      }
+      local.head = std::exchange(tail->next, nullptr);
+      local.count -= n;
+
+      Global& g = global();
+      std::lock_guard<std::mutex> lock(g.mutex);
+      tail->next = g.returned;
+      g.returned = head;
+      g.returned_count += n;
+    }
+
+    // take a batch from the blocks given back, or carve it from the current slab, or from a new one
+    static void refill(Local& local)
+    {
+      Global& g = global();
+      std::lock_guard<std::mutex> lock(g.mutex);
+      if (g.returned != nullptr)
+      {
+        const std::size_t n = std::min(g.returned_count, kBatchBlocks);
+        FreeBlock* tail = g.returned;
+        for (std::size_t i = 1; i < n; ++i)
+        {
+          tail = tail->next;
+        }
+        local.head = std::exchange(g.returned, std::exchange(tail->next, nullptr));
+        g.returned_count -= n;
+        local.count = n;
+        return;
+      }
+
+      if (g.carve == g.carve_end)
+      {
+        std::size_t blocks = g.next_slab_blocks;
+        auto* slab = static_cast<std::byte*>(::operator new(blocks * kBlockSize, std::align_val_t{ kAlign }));
+        try
+        {
+          g.slabs.push_back(slab);
+        }
+        catch (...)
+        {
+          ::operator delete(slab, std::align_val_t{ kAlign });
+          throw;
+        }
+        g.next_slab_blocks = std::min(blocks * 2, std::max(kMinSlabBlocks, kMaxSlabBytes / kBlockSize));
+        g.carve = slab;
+        g.carve_end = slab + blocks * kBlockSize;
+      }
+
+      // link the blocks in address order, so consecutive allocations are adjacent
+      const std::size_t n = std::min(kBatchBlocks, static_cast<std::size_t>(g.carve_end - g.carve) / kBlockSize);
+      FreeBlock* head = nullptr;
+      for (std::size_t i = n; i-- > 0;)
+      {
+        head = ::new (static_cast<void*>(g.carve + i * kBlockSize)) FreeBlock{ head };
+      }
+      g.carve += n * kBlockSize;
+      local.head = head;
+      local.count = n;
+    }
+  };
+
+  // A stateless standard allocator over NodePool, to plug into node-based containers:
+  //   std::list<int, mcpp::NodePoolAllocator<int>> list;
+  //   std::map<int, int, std::less<>, mcpp::NodePoolAllocator<std::pair<const int, int>>> map;
+  // The containers rebind it to their node type, so every node type gets its own pool. Single objects come from the pool,
+  // arrays (e.g. the bucket array of std::unordered_map) fall back to std::allocator.
+  template<typename T>
+  class NodePoolAllocator
+  {
+    using Pool = NodePool<sizeof(T), alignof(T)>;
+
+   public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template<typename U>
+    struct rebind
+    {
+      using other = NodePoolAllocator<U>;
+    };
+
+    NodePoolAllocator() noexcept = default;
+    template<typename U>
+    NodePoolAllocator(const NodePoolAllocator<U>& /*other*/) noexcept  // NOLINT(google-explicit-constructor)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+      if (n == 1)
+      {
+        return static_cast<T*>(Pool::allocate());
+      }
+      return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+      if (n == 1)
+      {
+        Pool::deallocate(p);
+        return;
+      }
+      std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const NodePoolAllocator<U>& /*other*/) const noexcept
+    {
+      return true;
+    }
+    template<typename U>
+    bool operator!=(const NodePoolAllocator<U>& /*other*/) const noexcept
+    {
+      return false;
+    }
+  };
+}  // namespace mcpp
+
+#endif  // NODE_POOL_H
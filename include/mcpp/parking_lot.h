@@ -0,0 +1,59 @@
+#ifndef PARKING_LOT_H
+#define PARKING_LOT_H
+
+#include <chrono>
+#include <cstddef>
+
+#include "mcpp/function_ref.h"
+
+namespace mcpp
+{
+  // WebKit's ParkingLot (https://webkit.org/blog/6161/locking-in-webkit/): the queuing and suspending of threads is moved out
+  // of the synchronization primitives into one global table keyed by address, so that a lock or a condition only needs a few
+  // bits of state, and the memory for waiting threads scales with the number of threads, not with the number of locks.
+  //
+  // The table is an array of buckets, each with its own lock and an intrusive FIFO queue of the threads parked on the
+  // addresses that hash to it, so parking on different addresses does not contend on a global lock. The nodes of the queues
+  // live in thread-local storage, and the callbacks are taken as FunctionRef, so parking and unparking never allocate, except
+  // once per thread to grow the table with the number of threads (the table is rebuilt under the locks of all the buckets,
+  // and the old one is kept so that a thread that is waiting on one of its bucket locks can notice and retry).
+  //
+  // A parked thread sleeps on a futex word of its own on Linux (FUTEX_WAIT_PRIVATE/FUTEX_WAKE_PRIVATE), and on a mutex and
+  // condition variable of its own elsewhere, or when built with -DMCPP_PARKING_LOT_FUTEX=0.
+  class ParkingLot
+  {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    // Park the calling thread on `address` if `validation` returns true.
+    //
+    // `validation` runs under the bucket lock of `address`, so no unpark on `address` can happen between the check and the
+    // enqueue. `before_sleep` runs after the thread is enqueued and the bucket lock released, e.g. to release the user lock
+    // of a condition variable. Returns true if the thread was unparked, false if validation failed or the timeout expired.
+    static bool parkConditionally(
+        const void* address,
+        FunctionRef<bool()> validation,
+        FunctionRef<void()> before_sleep,
+        Clock::time_point timeout = Clock::time_point::max());
+
+    // Unpark the thread that has been parked on `address` for the longest time, if any.
+    //
+    // `callback` runs under the bucket lock of `address` before the thread is woken up, with whether a thread was unparked
+    // and whether the queue of `address` is now empty, so that the caller can update its state atomically with the queue
+    // (e.g. clear the has-parked bit of a lock).
+    static void unparkOne(const void* address, FunctionRef<void(bool did_unpark, bool queue_empty)> callback);
+
+    // Unpark all the threads parked on `address`, in the order they parked. Returns how many were unparked.
+    static std::size_t unparkAll(const void* address);
+
+    // Unpark up to `wake_count` of the threads parked on `from`, and move the others to the queue of `to`, behind the
+    // threads already parked there. Returns how many were unparked. E.g. a broadcast on a condition can wake one waiter and
+    // requeue the rest on the address of the lock they all need next, instead of waking them all to contend on it.
+    static std::size_t unparkAndRequeue(const void* from, const void* to, std::size_t wake_count);
+
+    // number of buckets of the current table (for tests)
+    static std::size_t bucketCount();
+  };
+}  // namespace mcpp
+
+#endif  // PARKING_LOT_H
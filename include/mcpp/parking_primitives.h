@@ -0,0 +1,350 @@
+#ifndef PARKING_PRIMITIVES_H
+#define PARKING_PRIMITIVES_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "mcpp/parking_lot.h"
+
+namespace mcpp
+{
+  // Synchronization primitives that keep only a few bits of state and park on their own address in the ParkingLot, instead
+  // of embedding a mutex and a condition variable (80+ bytes with std::mutex + std::condition_variable) in every object.
+  // Each one sets a has-waiters bit under the bucket lock of its address before parking (in the validation callback), so
+  // the side that wakes up only calls into the ParkingLot when that bit is set, and cannot miss a thread that is parking.
+
+  // A condition variable in one byte, to be used with any BasicLockable (e.g. a std::mutex or a 1-byte parking lock).
+  class Condition
+  {
+   public:
+    using Clock = ParkingLot::Clock;
+
+    // Atomically release `lock` and park, then reacquire it. Returns false on timeout. As with std::condition_variable,
+    // the thread may also wake up without a notify, so the caller checks its predicate in a loop.
+    template<typename Lock>
+    bool wait_until(std::unique_lock<Lock>& lock, Clock::time_point timeout)
+    {
+      bool result = ParkingLot::parkConditionally(
+          this,
+          [this]()
+          {
+            has_waiters_.store(true);
+            return true;
+          },
+          [&lock]() { lock.unlock(); },
+          timeout);
+      lock.lock();
+      return result;
+    }
+
+    template<typename Lock>
+    void wait(std::unique_lock<Lock>& lock)
+    {
+      wait_until(lock, Clock::time_point::max());
+    }
+
+    template<typename Lock, typename Predicate>
+    void wait(std::unique_lock<Lock>& lock, Predicate predicate)
+    {
+      while (!predicate())
+      {
+        wait(lock);
+      }
+    }
+
+    // Returns the value of the predicate, false only if the timeout expired first.
+    template<typename Lock, typename Predicate>
+    bool wait_until(std::unique_lock<Lock>& lock, Clock::time_point timeout, Predicate predicate)
+    {
+      while (!predicate())
+      {
+        if (!wait_until(lock, timeout))
+        {
+          return predicate();
+        }
+      }
+      return true;
+    }
+
+    void notify_one()
+    {
+      if (!has_waiters_.load())
+      {
+        return;
+      }
+      ParkingLot::unparkOne(
+          this,
+          [this](bool /*did_unpark*/, bool queue_empty)
+          {
+            if (queue_empty)
+            {
+              has_waiters_.store(false);
+            }
+          });
+    }
+
+    void notify_all()
+    {
+      if (!has_waiters_.load())
+      {
+        return;
+      }
+      // a thread that parks after the store sets the bit again, under the bucket lock
+      has_waiters_.store(false);
+      ParkingLot::unparkAll(this);
+    }
+
+   private:
+    std::atomic<bool> has_waiters_{ false };
+  };
+
+  // A counting semaphore in one 32-bit word: the count in the upper 31 bits, the has-waiters bit in the lowest one.
+  class Semaphore
+  {
+   public:
+    using Clock = ParkingLot::Clock;
+
+    explicit Semaphore(std::uint32_t count = 0) : state_(count * kOne)
+    {
+    }
+
+    bool try_acquire()
+    {
+      std::uint32_t state = state_.load(std::memory_order_relaxed);
+      while (state >= kOne)
+      {
+        if (state_.compare_exchange_weak(state, state - kOne, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Returns false if the timeout expired before a unit was available.
+    bool try_acquire_until(Clock::time_point timeout)
+    {
+      while (!try_acquire())
+      {
+        bool unparked = ParkingLot::parkConditionally(
+            this,
+            [this]()
+            {
+              // park only while the count is 0, and say so in the state
+              std::uint32_t state = state_.load(std::memory_order_relaxed);
+              while (state < kOne)
+              {
+                if ((state & kHasWaiters) != 0 ||
+                    state_.compare_exchange_weak(state, state | kHasWaiters, std::memory_order_relaxed))
+                {
+                  return true;
+                }
+              }
+              return false;
+            },
+            []() {},
+            timeout);
+        if (!unparked && Clock::now() >= timeout)
+        {
+          return try_acquire();
+        }
+      }
+      return true;
+    }
+
+    void acquire()
+    {
+      try_acquire_until(Clock::time_point::max());
+    }
+
+    void release(std::uint32_t n = 1)
+    {
+      std::uint32_t state = state_.fetch_add(n * kOne, std::memory_order_release);
+      if ((state & kHasWaiters) == 0)
+      {
+        return;
+      }
+      // wake up one thread per unit; a woken thread may lose the unit to a thread that did not park, and parks again
+      bool more = true;
+      for (std::uint32_t i = 0; i < n && more; ++i)
+      {
+        ParkingLot::unparkOne(
+            this,
+            [this, &more](bool did_unpark, bool queue_empty)
+            {
+              more = did_unpark && !queue_empty;
+              if (queue_empty)
+              {
+                state_.fetch_and(~kHasWaiters, std::memory_order_relaxed);
+              }
+            });
+      }
+    }
+
+    std::uint32_t count() const
+    {
+      return state_.load(std::memory_order_relaxed) / kOne;
+    }
+
+   private:
+    static constexpr std::uint32_t kHasWaiters = 1;
+    static constexpr std::uint32_t kOne = 2;
+
+    std::atomic<std::uint32_t> state_;
+  };
+
+  // A one-shot event in one byte: wait() blocks until set() is called once, and returns immediately after that.
+  class Event
+  {
+   public:
+    using Clock = ParkingLot::Clock;
+
+    void set()
+    {
+      if (state_.exchange(kSet, std::memory_order_release) == kHasWaiters)
+      {
+        ParkingLot::unparkAll(this);
+      }
+    }
+
+    bool is_set() const
+    {
+      return state_.load(std::memory_order_acquire) == kSet;
+    }
+
+    // Returns false if the timeout expired before the event was set.
+    bool wait_until(Clock::time_point timeout)
+    {
+      while (!is_set())
+      {
+        bool unparked = ParkingLot::parkConditionally(
+            this,
+            [this]()
+            {
+              std::uint8_t state = kUnset;
+              return state_.compare_exchange_strong(state, kHasWaiters, std::memory_order_relaxed) || state == kHasWaiters;
+            },
+            []() {},
+            timeout);
+        if (!unparked && Clock::now() >= timeout)
+        {
+          return is_set();
+        }
+      }
+      return true;
+    }
+
+    void wait()
+    {
+      wait_until(Clock::time_point::max());
+    }
+
+   private:
+    static constexpr std::uint8_t kUnset = 0;
+    static constexpr std::uint8_t kHasWaiters = 1;
+    static constexpr std::uint8_t kSet = 2;
+
+    std::atomic<std::uint8_t> state_{ kUnset };
+  };
+
+  // A readers-writer lock in one 32-bit word: the writer bit, the has-waiters bit, and the number of readers above them.
+  // Readers and writers park on the same address and are all woken up when the lock becomes free, to compete again. There
+  // is no writer preference: a steady stream of readers can starve a writer. Satisfies SharedMutex (std::shared_lock).
+  class RWLock
+  {
+   public:
+    bool try_lock()
+    {
+      std::uint32_t state = state_.load(std::memory_order_relaxed);
+      while ((state & ~kHasWaiters) == 0)
+      {
+        if (state_.compare_exchange_weak(state, state | kWriter, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void lock()
+    {
+      while (!try_lock())
+      {
+        park_while([](std::uint32_t state) { return (state & ~kHasWaiters) != 0; });
+      }
+    }
+
+    void unlock()
+    {
+      std::uint32_t state = state_.fetch_and(~(kWriter | kHasWaiters), std::memory_order_release);
+      if ((state & kHasWaiters) != 0)
+      {
+        ParkingLot::unparkAll(this);
+      }
+    }
+
+    bool try_lock_shared()
+    {
+      std::uint32_t state = state_.load(std::memory_order_relaxed);
+      while ((state & kWriter) == 0)
+      {
+        if (state_.compare_exchange_weak(state, state + kReader, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void lock_shared()
+    {
+      while (!try_lock_shared())
+      {
+        park_while([](std::uint32_t state) { return (state & kWriter) != 0; });
+      }
+    }
+
+    void unlock_shared()
+    {
+      std::uint32_t state = state_.fetch_sub(kReader, std::memory_order_release) - kReader;
+      // the last reader wakes up the waiters, unless the lock was taken again in between: then its owner will
+      std::uint32_t expected = kHasWaiters;
+      if (state == kHasWaiters && state_.compare_exchange_strong(expected, 0, std::memory_order_relaxed))
+      {
+        ParkingLot::unparkAll(this);
+      }
+    }
+
+   private:
+    static constexpr std::uint32_t kWriter = 1;
+    static constexpr std::uint32_t kHasWaiters = 2;
+    static constexpr std::uint32_t kReader = 4;
+
+    // park while `blocked(state)`, setting the has-waiters bit
+    template<typename Blocked>
+    void park_while(Blocked blocked)
+    {
+      ParkingLot::parkConditionally(
+          this,
+          [this, &blocked]()
+          {
+            std::uint32_t state = state_.load(std::memory_order_relaxed);
+            while (blocked(state))
+            {
+              if ((state & kHasWaiters) != 0 ||
+                  state_.compare_exchange_weak(state, state | kHasWaiters, std::memory_order_relaxed))
+              {
+                return true;
+              }
+            }
+            return false;
+          },
+          []() {});
+    }
+
+    std::atomic<std::uint32_t> state_{ 0 };
+  };
+}  // namespace mcpp
+
+#endif  // PARKING_PRIMITIVES_H
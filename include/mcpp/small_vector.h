@@ -0,0 +1,339 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "mcpp/vector.h"
+#include "mcpp/vector_trace.h"
+
+namespace vector
+{
+  // A vector that keeps the first N elements inside the object and only spills to the heap past N, so that small vectors
+  // do not allocate at all. It has the same API as Vector.
+  //
+  // The price is the object size (N * sizeof(T) more bytes) and the move: inline elements cannot be stolen, they are
+  // relocated one by one (a memcpy for trivially relocatable types), only heap storage is stolen like in Vector.
+  template<typename T, int N, typename Trace = DefaultTrace>
+  class SmallVector
+  {
+    static_assert(N > 0, "use Vector if there is no inline capacity");
+
+   private:
+    T* elem{ inline_data() };
+    int sz{};
+    int cap{ N };
+    alignas(T) std::byte inline_buf[sizeof(T) * static_cast<std::size_t>(N)];
+
+   public:
+    using value_type = T;
+
+    SmallVector() = default;
+
+    // the constructors delegate to the default one, so that the destructor cleans up if an element constructor throws.
+    explicit SmallVector(int size) : SmallVector()
+    {
+      reserve(size);
+      // value-initialize (zero for arithmetic types) like Vector(int)
+      for (; sz < size; ++sz)
+      {
+        ::new (static_cast<void*>(elem + sz)) T();
+      }
+    }
+
+    SmallVector(std::initializer_list<T> list) : SmallVector()
+    {
+      reserve(static_cast<int>(list.size()));
+      for (const T& value : list)
+      {
+        ::new (static_cast<void*>(elem + sz)) T(value);
+        ++sz;
+      }
+    }
+
+    SmallVector(const SmallVector& input) : SmallVector()
+    {
+      Trace::on(SpecialMember::CopyConstructor);
+      reserve(input.sz);
+      copy_construct(input.elem, input.sz, elem);
+      sz = input.sz;
+    };  // copy constructor
+    SmallVector& operator=(const SmallVector& input)
+    {
+      Trace::on(SpecialMember::CopyAssignment);
+      if (this != &input)
+      {
+        clear();
+        reserve(input.sz);
+        copy_construct(input.elem, input.sz, elem);
+        sz = input.sz;
+      }
+      return *this;
+    };  // copy assignment
+
+    SmallVector(SmallVector&& input) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+      Trace::on(SpecialMember::MoveConstructor);
+      take(input);
+    };  // move constructor
+    SmallVector& operator=(SmallVector&& input) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+      Trace::on(SpecialMember::MoveAssignment);
+      if (this != &input)
+      {
+        clear();
+        release_heap();
+        take(input);
+      }
+      return *this;
+    };  // move assignment
+
+    ~SmallVector()
+    {
+      clear();
+      release_heap();
+      Trace::on(SpecialMember::Destructor);
+    }
+
+    T& operator[](int idx)
+    {
+      return elem[idx];
+    }
+    const T& operator[](int idx) const
+    {
+      return elem[idx];
+    }
+    int size() const
+    {
+      return sz;
+    }
+    int capacity() const
+    {
+      return cap;
+    }
+    bool empty() const
+    {
+      return sz == 0;
+    }
+    T* begin()
+    {
+      return elem;
+    }
+    T* end()
+    {
+      return elem + sz;
+    }
+    const T* begin() const
+    {
+      return elem;
+    }
+    const T* end() const
+    {
+      return elem + sz;
+    }
+
+    // whether the elements live in the inline buffer, i.e. the vector does not own any heap memory.
+    bool is_inline() const
+    {
+      return elem == inline_data();
+    }
+
+    void clear() noexcept
+    {
+      std::destroy_n(elem, sz);
+      sz = 0;
+    }
+
+    void reserve(int new_cap)
+    {
+      if (new_cap > cap)
+      {
+        reallocate(new_cap);
+      }
+    }
+
+    // move the elements back into the inline buffer if they fit, otherwise shrink the heap storage to size().
+    void shrink_to_fit()
+    {
+      if (is_inline() || cap == sz)
+      {
+        return;
+      }
+      if (sz <= N)
+      {
+        T* heap = elem;
+        relocate(heap, sz, inline_data());
+        elem = inline_data();
+        deallocate(heap, cap);
+        cap = N;
+      }
+      else
+      {
+        reallocate(sz);
+      }
+    }
+
+    void push_back(const T& value)
+    {
+      emplace_back(value);
+    }
+    void push_back(T&& value)
+    {
+      emplace_back(std::move(value));
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+      if (sz < cap)
+      {
+        ::new (static_cast<void*>(elem + sz)) T(std::forward<Args>(args)...);
+        return elem[sz++];
+      }
+
+      // `args` may refer to an element of this vector, so construct the new element before relocating the old ones.
+      int new_cap = cap * 2;
+      T* p = allocate(new_cap);
+      try
+      {
+        ::new (static_cast<void*>(p + sz)) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        deallocate(p, new_cap);
+        throw;
+      }
+      try
+      {
+        relocate(elem, sz, p);
+      }
+      catch (...)
+      {
+        p[sz].~T();
+        deallocate(p, new_cap);
+        throw;
+      }
+      release_heap();
+      elem = p;
+      cap = new_cap;
+      return elem[sz++];
+    }
+
+   private:
+    T* inline_data() noexcept
+    {
+      return reinterpret_cast<T*>(inline_buf);  // NOLINT
+    }
+    const T* inline_data() const noexcept
+    {
+      return reinterpret_cast<const T*>(inline_buf);  // NOLINT
+    }
+
+    static T* allocate(int n)
+    {
+      return std::allocator<T>().allocate(static_cast<std::size_t>(n));
+    }
+
+    static void deallocate(T* p, int n) noexcept
+    {
+      std::allocator<T>().deallocate(p, static_cast<std::size_t>(n));
+    }
+
+    // free the heap storage (elements must have been destroyed or relocated) and go back to the inline buffer.
+    void release_heap() noexcept
+    {
+      if (!is_inline())
+      {
+        deallocate(elem, cap);
+        elem = inline_data();
+        cap = N;
+      }
+    }
+
+    // steal the heap storage of `input`, or relocate its inline elements into our (empty) inline buffer.
+    void take(SmallVector& input)
+    {
+      if (input.is_inline())
+      {
+        relocate(input.elem, input.sz, elem);
+        sz = input.sz;
+      }
+      else
+      {
+        elem = input.elem;
+        sz = input.sz;
+        cap = input.cap;
+        input.elem = input.inline_data();
+        input.cap = N;
+      }
+      input.sz = 0;
+    }
+
+    static void copy_construct(const T* src, int n, T* dst)
+    {
+      if constexpr (std::is_trivially_copyable_v<T>)
+      {
+        if (n > 0)
+        {
+          std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), static_cast<std::size_t>(n) * sizeof(T));
+        }
+      }
+      else
+      {
+        std::uninitialized_copy(src, src + n, dst);
+      }
+    }
+
+    // same contract as Vector's relocate: the source elements are gone afterwards, or untouched if it throws.
+    static void relocate(T* src, int n, T* dst)
+    {
+      if constexpr (is_trivially_relocatable_v<T>)
+      {
+        if (n > 0)
+        {
+          std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), static_cast<std::size_t>(n) * sizeof(T));
+        }
+      }
+      else
+      {
+        int i = 0;
+        try
+        {
+          for (; i < n; ++i)
+          {
+            ::new (static_cast<void*>(dst + i)) T(std::move_if_noexcept(src[i]));
+          }
+        }
+        catch (...)
+        {
+          std::destroy_n(dst, i);
+          throw;
+        }
+        std::destroy_n(src, n);
+      }
+    }
+
+    void reallocate(int new_cap)
+    {
+      T* p = allocate(new_cap);
+      try
+      {
+        relocate(elem, sz, p);
+      }
+      catch (...)
+      {
+        deallocate(p, new_cap);
+        throw;
+      }
+      release_heap();
+      elem = p;
+      cap = new_cap;
+    }
+  };
+}  // namespace vector
+
+#endif  // SMALL_VECTOR_H
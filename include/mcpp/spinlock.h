@@ -0,0 +1,350 @@
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace mcpp
+{
+  // Spinlocks, all Lockable (lock/try_lock/unlock, for std::lock_guard and std::unique_lock) but CLHLock, which is only
+  // BasicLockable (lock/unlock).
+  //
+  // A spinning thread burns its core, and when the owner of the lock is preempted (more runnable threads than cores), the
+  // waiters spin for nothing: use these only for short critical sections with at most one thread per core, and measure
+  // (benchmark/spinlock) against std::mutex, which spins briefly before it sleeps. All of them back off with pause and
+  // start to yield after a few thousand pauses, so that an oversubscribed machine still makes progress, slowly.
+  //   TASLock:    exchange in a loop with exponential backoff. Every attempt writes the cache line.
+  //   TTASLock:   spins on loads, which hit the local copy of the line, and only exchanges once the lock looks free.
+  //   TicketLock: FIFO, waiters spin on now_serving and back off in proportion to their distance to it.
+  //   MCSLock:    FIFO queue of per-thread nodes, each waiter spins on a flag in its own node (its own cache line).
+  //   CLHLock:    FIFO queue like MCS, each waiter spins on a flag in the node of its predecessor.
+  // With the queue locks a handoff goes to a single waiter, which is fair but collapses under oversubscription: the next
+  // owner may not be running.
+
+  constexpr std::size_t kCacheLineSize = 64;
+
+  // tell the core that we are spinning (x86 pause): saves power, and frees the pipeline for the other hyper-thread
+  inline void cpu_relax()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  // Backoff of a spinning waiter: pause, and once it has paused kSpinLimit times, yield instead, since by then the thread it
+  // waits for is most likely not running.
+  class SpinWait
+  {
+   public:
+    // exponential backoff: 1, 2, 4, ... pauses
+    void wait()
+    {
+      pause(backoff_);
+      backoff_ = backoff_ < kMaxBackoff ? backoff_ * 2 : backoff_;
+    }
+
+    void pause(std::uint32_t n)
+    {
+      if (spins_ >= kSpinLimit)
+      {
+        std::this_thread::yield();
+        return;
+      }
+      for (std::uint32_t i = 0; i < n; ++i)
+      {
+        cpu_relax();
+      }
+      spins_ += n;
+    }
+
+   private:
+    static constexpr std::uint32_t kMaxBackoff = 1024;
+    static constexpr std::uint32_t kSpinLimit = 4096;
+
+    std::uint32_t backoff_ = 1;
+    std::uint32_t spins_ = 0;
+  };
+
+  // Each lock takes a cache line of its own, so that spinning on it does not slow down the accesses to its neighbours.
+  class alignas(kCacheLineSize) TASLock
+  {
+   public:
+    void lock()
+    {
+      SpinWait spin;
+      while (locked_.exchange(true, std::memory_order_acquire))
+      {
+        spin.wait();
+      }
+    }
+
+    bool try_lock()
+    {
+      return !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock()
+    {
+      locked_.store(false, std::memory_order_release);
+    }
+
+   private:
+    std::atomic<bool> locked_{ false };
+  };
+
+  // https://rigtorp.se/spinlock/
+  class alignas(kCacheLineSize) TTASLock
+  {
+   public:
+    void lock()
+    {
+      SpinWait spin;
+      for (;;)
+      {
+        if (!locked_.exchange(true, std::memory_order_acquire))
+        {
+          return;
+        }
+        while (locked_.load(std::memory_order_relaxed))
+        {
+          spin.pause(1);
+        }
+      }
+    }
+
+    // load first, so that a failing try_lock in a loop does not write the line
+    bool try_lock()
+    {
+      return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock()
+    {
+      locked_.store(false, std::memory_order_release);
+    }
+
+   private:
+    std::atomic<bool> locked_{ false };
+  };
+
+  class alignas(kCacheLineSize) TicketLock
+  {
+   public:
+    void lock()
+    {
+      const std::uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+      SpinWait spin;
+      for (;;)
+      {
+        const std::uint32_t serving = now_serving_.load(std::memory_order_acquire);
+        if (serving == ticket)
+        {
+          return;
+        }
+        // the waiters ahead of us need at least that many handoffs
+        spin.pause((ticket - serving) * kBackoffPerWaiter);
+      }
+    }
+
+    bool try_lock()
+    {
+      std::uint32_t serving = now_serving_.load(std::memory_order_acquire);
+      std::uint32_t expected = serving;
+      return next_.compare_exchange_strong(expected, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock()
+    {
+      // only the owner writes now_serving
+      now_serving_.store(now_serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+   private:
+    static constexpr std::uint32_t kBackoffPerWaiter = 16;
+
+    // in two lines: the arrivals increment next_, the waiters only read now_serving_
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> next_{ 0 };
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> now_serving_{ 0 };
+  };
+
+  namespace detail
+  {
+    // The queue nodes of MCS and CLH, one cache line each. Lockable has no room for a node argument, so a thread takes its
+    // nodes from a thread-local free list, allocated on first use and freed at thread exit.
+    struct alignas(kCacheLineSize) QueueNode
+    {
+      std::atomic<bool> locked{ false };
+      std::atomic<QueueNode*> next{ nullptr };
+    };
+
+    class QueueNodeCache
+    {
+     public:
+      QueueNodeCache() = default;
+      QueueNodeCache(const QueueNodeCache&) = delete;
+      QueueNodeCache& operator=(const QueueNodeCache&) = delete;
+
+      ~QueueNodeCache()
+      {
+        while (free_ != nullptr)
+        {
+          QueueNode* node = free_;
+          free_ = node->next.load(std::memory_order_relaxed);
+          delete node;
+        }
+      }
+
+      static QueueNode* get()
+      {
+        QueueNodeCache& cache = local();
+        QueueNode* node = cache.free_;
+        if (node == nullptr)
+        {
+          return new QueueNode;
+        }
+        cache.free_ = node->next.load(std::memory_order_relaxed);
+        node->next.store(nullptr, std::memory_order_relaxed);
+        return node;
+      }
+
+      static void put(QueueNode* node)
+      {
+        QueueNodeCache& cache = local();
+        node->next.store(cache.free_, std::memory_order_relaxed);
+        cache.free_ = node;
+      }
+
+     private:
+      static QueueNodeCache& local()
+      {
+        thread_local QueueNodeCache cache;
+        return cache;
+      }
+
+      QueueNode* free_{ nullptr };
+    };
+  }  // namespace detail
+
+  // Mellor-Crummey and Scott, "Algorithms for scalable synchronization on shared-memory multiprocessors" (1991)
+  class alignas(kCacheLineSize) MCSLock
+  {
+   public:
+    void lock()
+    {
+      detail::QueueNode* node = detail::QueueNodeCache::get();
+      node->locked.store(true, std::memory_order_relaxed);
+      detail::QueueNode* prev = tail_.exchange(node, std::memory_order_acq_rel);
+      if (prev != nullptr)
+      {
+        prev->next.store(node, std::memory_order_release);
+        SpinWait spin;
+        while (node->locked.load(std::memory_order_acquire))
+        {
+          spin.pause(1);
+        }
+      }
+      owner_ = node;
+    }
+
+    bool try_lock()
+    {
+      detail::QueueNode* node = detail::QueueNodeCache::get();
+      detail::QueueNode* expected = nullptr;
+      if (!tail_.compare_exchange_strong(expected, node, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        detail::QueueNodeCache::put(node);
+        return false;
+      }
+      owner_ = node;
+      return true;
+    }
+
+    void unlock()
+    {
+      detail::QueueNode* node = owner_;
+      detail::QueueNode* next = node->next.load(std::memory_order_acquire);
+      if (next == nullptr)
+      {
+        detail::QueueNode* expected = node;
+        if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+        {
+          detail::QueueNodeCache::put(node);
+          return;
+        }
+        // a thread swapped itself in as the tail, wait until it links itself behind us
+        SpinWait spin;
+        while ((next = node->next.load(std::memory_order_acquire)) == nullptr)
+        {
+          spin.pause(1);
+        }
+      }
+      next->locked.store(false, std::memory_order_release);
+      // nobody references our node anymore
+      detail::QueueNodeCache::put(node);
+    }
+
+   private:
+    std::atomic<detail::QueueNode*> tail_{ nullptr };
+    detail::QueueNode* owner_{ nullptr };  // the node of the owner, only accessed by the owner
+  };
+
+  // Craig, and Magnusson, Landin and Hagersten (1993). The queue always holds a node: the lock starts with an unlocked one,
+  // and the owner releases the lock by clearing the flag of its node, then takes over the node of its predecessor, which
+  // nobody references anymore.
+  //
+  // There is no try_lock: a thread joins the queue by swapping the tail, and the node it sees may have been released,
+  // recycled and queued again behind another owner since it was read (ABA), so a thread that is in the queue may have to
+  // wait, and it cannot leave the queue without the lock. Use MCSLock where try_lock is needed.
+  class alignas(kCacheLineSize) CLHLock
+  {
+   public:
+    CLHLock() : tail_(new detail::QueueNode)
+    {
+    }
+
+    CLHLock(const CLHLock&) = delete;
+    CLHLock& operator=(const CLHLock&) = delete;
+
+    ~CLHLock()
+    {
+      delete tail_.load(std::memory_order_relaxed);
+    }
+
+    void lock()
+    {
+      detail::QueueNode* node = detail::QueueNodeCache::get();
+      node->locked.store(true, std::memory_order_relaxed);
+      detail::QueueNode* prev = tail_.exchange(node, std::memory_order_acq_rel);
+      SpinWait spin;
+      while (prev->locked.load(std::memory_order_acquire))
+      {
+        spin.pause(1);
+      }
+      owner_ = node;
+      owner_prev_ = prev;
+    }
+
+    void unlock()
+    {
+      detail::QueueNode* prev = owner_prev_;
+      owner_->locked.store(false, std::memory_order_release);
+      detail::QueueNodeCache::put(prev);
+    }
+
+   private:
+    std::atomic<detail::QueueNode*> tail_;
+    // the nodes of the owner and of its predecessor, only accessed by the owner
+    detail::QueueNode* owner_{ nullptr };
+    detail::QueueNode* owner_prev_{ nullptr };
+  };
+}  // namespace mcpp
+
+#endif  // SPINLOCK_H
@@ -1,75 +1,448 @@
-#include <cstdio>
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include "initializer_list"
+#include "mcpp/vector_trace.h"
 
 namespace vector
 {
+  // Type trait to detect whether moving an object to a new address and ending the lifetime of the old one is equivalent to
+  // a memcpy of its bytes. It holds for trivially copyable types, and user types can opt in with a specialization, e.g. a type
+  // that owns a std::unique_ptr:
+  //   template<> struct vector::is_trivially_relocatable<MyType> : std::true_type {};
+  // Do not opt in a type that stores a pointer to itself (or is referenced by address from somewhere else).
   template<typename T>
-  class Vector
+  struct is_trivially_relocatable : std::is_trivially_copyable<T>
+  {
+  };
+  template<typename T>
+  inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+  // Alloc: a standard allocator, e.g. std::pmr::polymorphic_allocator<T> to back the vector with a memory resource
+  // (see std::pmr::monotonic_buffer_resource). It is a private base class so that a stateless allocator takes no space
+  // (empty base optimization).
+  // Trace: compile-time tracing policy of the special member functions, see mcpp/vector_trace.h
+  template<typename T, typename Alloc = std::allocator<T>, typename Trace = DefaultTrace>
+  class Vector : private Alloc
   {
+    using alloc_traits = std::allocator_traits<Alloc>;
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>, "Alloc::value_type must be T");
+
    private:
-    T* elem;
+    T* elem{};
     int sz{};
+    int cap{};
 
    public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
     Vector() = default;
 
-    explicit Vector(int size);
+    explicit Vector(const Alloc& alloc) noexcept : Alloc(alloc)
+    {
+    }
+
+    explicit Vector(int size, const Alloc& alloc = Alloc()) : Alloc(alloc), elem{ allocate(size) }, sz{ size }, cap{ size }
+    {
+      // value-initialize (zero for arithmetic types) the raw storage, like `new T[size]{}` did
+      // non c++11 use std::memset
+      // std::memset(elem, 0, static_cast<unsigned long>(size) * sizeof(T));
+      int i = 0;
+      try
+      {
+        for (; i < size; ++i)
+        {
+          alloc_traits::construct(get_alloc(), elem + i);
+        }
+      }
+      catch (...)
+      {
+        destroy(elem, i);
+        deallocate(elem, cap);
+        throw;
+      }
+    }
 
     // initialize with a list of doubles
-    Vector(std::initializer_list<T> list);
+    Vector(std::initializer_list<T> list, const Alloc& alloc = Alloc())
+        : Alloc(alloc),
+          elem{ allocate(static_cast<int>(list.size())) },
+          sz{ static_cast<int>(list.size()) },
+          cap{ static_cast<int>(list.size()) }
+    {
+      try
+      {
+        copy_construct(list.begin(), sz, elem);
+      }
+      catch (...)
+      {
+        deallocate(elem, cap);
+        throw;
+      }
+    }
 
-    Vector(const Vector& input) : elem(new T[static_cast<unsigned long>(input.sz)]), sz(input.sz)
+    Vector(const Vector& input)
+        : Alloc(alloc_traits::select_on_container_copy_construction(input.get_alloc())),
+          elem(allocate(input.sz)),
+          sz(input.sz),
+          cap(input.sz)
     {
-      puts("copy constructor");
-      for (int i = 0; i < sz; ++i)
+      Trace::on(SpecialMember::CopyConstructor);
+      try
       {
-        elem[i] = input.elem[i];
+        copy_construct(input.elem, input.sz, elem);
+      }
+      catch (...)
+      {
+        deallocate(elem, cap);
+        throw;
       }
     };  // copy constructor
     Vector& operator=(const Vector& input)
     {
-      puts("copy assignment");
-      T* p = new T[static_cast<unsigned long>(input.sz)];
-      for (int i = 0; i < input.sz; ++i)
+      Trace::on(SpecialMember::CopyAssignment);
+      if (this == &input)
+      {
+        return *this;
+      }
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+      {
+        // the old storage must be released by the allocator that allocated it
+        if (get_alloc() != input.get_alloc())
+        {
+          destroy_and_deallocate();
+          elem = nullptr;
+          sz = 0;
+          cap = 0;
+        }
+        get_alloc() = input.get_alloc();
+      }
+      T* p = allocate(input.sz);
+      try
+      {
+        copy_construct(input.elem, input.sz, p);
+      }
+      catch (...)
       {
-        p[i] = input.elem[i];
+        deallocate(p, input.sz);
+        throw;
       }
-      delete[] elem;
+      destroy_and_deallocate();
       elem = p;
       sz = input.sz;
+      cap = input.sz;
       return *this;
     };  // copy assignment
 
     // noexcept: https://gieseanw.wordpress.com/2020/08/28/friendly-reminder-to-mark-your-move-constructors-noexcept/
     // means reference that can be stolen from given any type
-    Vector(Vector&& input) noexcept : elem(input.elem), sz(input.sz)
+    Vector(Vector&& input) noexcept : Alloc(std::move(input.get_alloc())), elem(input.elem), sz(input.sz), cap(input.cap)
     {
-      puts("move constructor");
+      Trace::on(SpecialMember::MoveConstructor);
       input.elem = nullptr;
       input.sz = 0;
+      input.cap = 0;
     };  // move constructor
-    Vector& operator=(Vector&& input) noexcept
+
+    // the storage can only be stolen if it will be released by an equal allocator, otherwise (e.g. two
+    // polymorphic_allocators with different memory resources) the elements are moved one by one.
+    Vector& operator=(Vector&& input) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
     {
-      puts("move assignment");
-      delete[] elem;
+      Trace::on(SpecialMember::MoveAssignment);
+      if (this == &input)
+      {
+        return *this;
+      }
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+      {
+        destroy_and_deallocate();
+        get_alloc() = std::move(input.get_alloc());
+      }
+      else if (!alloc_traits::is_always_equal::value && get_alloc() != input.get_alloc())
+      {
+        T* p = allocate(input.sz);
+        try
+        {
+          relocate(input.elem, input.sz, p);
+        }
+        catch (...)
+        {
+          deallocate(p, input.sz);
+          throw;
+        }
+        destroy_and_deallocate();
+        elem = p;
+        sz = input.sz;
+        cap = input.sz;
+        // input keeps its storage, but its elements have been relocated
+        input.sz = 0;
+        return *this;
+      }
+      else
+      {
+        destroy_and_deallocate();
+      }
       elem = input.elem;
       sz = input.sz;
+      cap = input.cap;
       input.elem = nullptr;
       input.sz = 0;
+      input.cap = 0;
       return *this;
     };  // move assignment
 
     ~Vector()
     {
-      delete[] elem;
-      puts("destructor");
+      destroy_and_deallocate();
+      Trace::on(SpecialMember::Destructor);
     }
 
-    T& operator[](int idx);
-    int size()
+    Alloc get_allocator() const
+    {
+      return get_alloc();
+    }
+
+    T& operator[](int idx)
+    {
+      return elem[idx];
+    }
+    const T& operator[](int idx) const
+    {
+      return elem[idx];
+    }
+    int size() const
     {
       return sz;
     }
+    int capacity() const
+    {
+      return cap;
+    }
+    bool empty() const
+    {
+      return sz == 0;
+    }
+    T* begin()
+    {
+      return elem;
+    }
+    T* end()
+    {
+      return elem + sz;
+    }
+    const T* begin() const
+    {
+      return elem;
+    }
+    const T* end() const
+    {
+      return elem + sz;
+    }
+
+    // grow the storage to hold at least `new_cap` elements, existing elements are relocated into the new storage.
+    void reserve(int new_cap)
+    {
+      if (new_cap > cap)
+      {
+        reallocate(new_cap);
+      }
+    }
+
+    // release the unused capacity, it is a binding request here unlike std::vector.
+    void shrink_to_fit()
+    {
+      if (cap > sz)
+      {
+        reallocate(sz);
+      }
+    }
+
+    void push_back(const T& value)
+    {
+      emplace_back(value);
+    }
+    void push_back(T&& value)
+    {
+      emplace_back(std::move(value));
+    }
+
+    // construct the element in place with perfect forwarding, capacity grows geometrically (x2) so that appending n
+    // elements costs amortized O(1) per element.
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+      if (sz < cap)
+      {
+        alloc_traits::construct(get_alloc(), elem + sz, std::forward<Args>(args)...);
+        return elem[sz++];
+      }
+
+      // `args` may refer to an element of this vector, so construct the new element before relocating the old ones.
+      int new_cap = next_capacity();
+      T* p = allocate(new_cap);
+      try
+      {
+        alloc_traits::construct(get_alloc(), p + sz, std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        deallocate(p, new_cap);
+        throw;
+      }
+      try
+      {
+        relocate(elem, sz, p);
+      }
+      catch (...)
+      {
+        alloc_traits::destroy(get_alloc(), p + sz);
+        deallocate(p, new_cap);
+        throw;
+      }
+      deallocate(elem, cap);
+      elem = p;
+      cap = new_cap;
+      return elem[sz++];
+    }
+
+   private:
+    Alloc& get_alloc() noexcept
+    {
+      return *this;
+    }
+    const Alloc& get_alloc() const noexcept
+    {
+      return *this;
+    }
+
+    T* allocate(int n)
+    {
+      if (n == 0)
+      {
+        return nullptr;
+      }
+      return alloc_traits::allocate(get_alloc(), static_cast<std::size_t>(n));
+    }
+
+    void deallocate(T* p, int n) noexcept
+    {
+      if (p != nullptr)
+      {
+        alloc_traits::deallocate(get_alloc(), p, static_cast<std::size_t>(n));
+      }
+    }
+
+    void destroy(T* p, int n) noexcept
+    {
+      if constexpr (!std::is_trivially_destructible_v<T>)
+      {
+        for (int i = 0; i < n; ++i)
+        {
+          alloc_traits::destroy(get_alloc(), p + i);
+        }
+      }
+    }
+
+    // copy `n` elements of `src` into the uninitialized storage `dst`, a single memcpy for trivially copyable types.
+    void copy_construct(const T* src, int n, T* dst)
+    {
+      if constexpr (std::is_trivially_copyable_v<T>)
+      {
+        if (n > 0)
+        {
+          std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), static_cast<std::size_t>(n) * sizeof(T));
+        }
+      }
+      else
+      {
+        int i = 0;
+        try
+        {
+          for (; i < n; ++i)
+          {
+            alloc_traits::construct(get_alloc(), dst + i, src[i]);
+          }
+        }
+        catch (...)
+        {
+          destroy(dst, i);
+          throw;
+        }
+      }
+    }
+
+    // move `n` elements of `src` into the uninitialized storage `dst` and end the lifetime of the source elements, so the
+    // source storage only needs to be deallocated afterwards.
+    // Trivially relocatable types are a single memcpy, otherwise elements are moved (or copied if the move constructor may
+    // throw, see std::move_if_noexcept) one by one, and the source is left untouched if that throws.
+    void relocate(T* src, int n, T* dst)
+    {
+      if constexpr (is_trivially_relocatable_v<T>)
+      {
+        if (n > 0)
+        {
+          std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), static_cast<std::size_t>(n) * sizeof(T));
+        }
+      }
+      else
+      {
+        int i = 0;
+        try
+        {
+          for (; i < n; ++i)
+          {
+            alloc_traits::construct(get_alloc(), dst + i, std::move_if_noexcept(src[i]));
+          }
+        }
+        catch (...)
+        {
+          destroy(dst, i);
+          throw;
+        }
+        destroy(src, n);
+      }
+    }
+
+    int next_capacity() const
+    {
+      return cap == 0 ? 1 : cap * 2;
+    }
+
+    void reallocate(int new_cap)
+    {
+      T* p = allocate(new_cap);
+      try
+      {
+        relocate(elem, sz, p);
+      }
+      catch (...)
+      {
+        deallocate(p, new_cap);
+        throw;
+      }
+      deallocate(elem, cap);
+      elem = p;
+      cap = new_cap;
+    }
+
+    void destroy_and_deallocate() noexcept
+    {
+      destroy(elem, sz);
+      deallocate(elem, cap);
+    }
   };
+
+  // explicitly instantiated in src/vector.cpp
+  extern template class Vector<int>;
+  extern template class Vector<double>;
 }  // namespace vector
+
+#endif  // VECTOR_H
@@ -0,0 +1,133 @@
+#ifndef VECTOR_KERNELS_H
+#define VECTOR_KERNELS_H
+
+#include <cstddef>
+
+#include "mcpp/vector.h"
+
+// SIMD reductions and element-wise kernels over the storage of vector::Vector<int> and vector::Vector<double>.
+//
+// Every kernel has a scalar, an SSE4.1 and an AVX2 implementation (src/vector_kernels.cpp). The AVX2/SSE4.1 code is
+// compiled with `__attribute__((target(...)))`, so the library itself does not need -mavx2, and the best implementation
+// the CPU supports is selected once at runtime via CPUID.
+//
+// Note: the double kernels (sum, dot, prefix_sum) add in a different order than a sequential loop, so the results may
+// differ in the last bits from std::accumulate.
+namespace vector::kernels
+{
+  enum class Isa
+  {
+    Scalar,
+    Sse41,
+    Avx2
+  };
+
+  // the best instruction set supported by the running CPU
+  Isa best_isa();
+  bool supported(Isa isa);
+  const char* isa_name(Isa isa);
+
+  // the kernels of one instruction set, working on raw storage
+  struct Table
+  {
+    long long (*sum_i32)(const int* x, std::size_t n);
+    double (*sum_f64)(const double* x, std::size_t n);
+    // min/max of an empty range is the identity of the operation: INT_MAX/INT_MIN, +/-infinity
+    int (*min_i32)(const int* x, std::size_t n);
+    int (*max_i32)(const int* x, std::size_t n);
+    double (*min_f64)(const double* x, std::size_t n);
+    double (*max_f64)(const double* x, std::size_t n);
+    long long (*dot_i32)(const int* x, const int* y, std::size_t n);
+    double (*dot_f64)(const double* x, const double* y, std::size_t n);
+    // y = a * x + y (int wraps around on overflow)
+    void (*axpy_i32)(int a, const int* x, int* y, std::size_t n);
+    void (*axpy_f64)(double a, const double* x, double* y, std::size_t n);
+    // in-place inclusive prefix sum (int wraps around on overflow)
+    void (*prefix_sum_i32)(int* x, std::size_t n);
+    void (*prefix_sum_f64)(double* x, std::size_t n);
+  };
+
+  // the kernels of `isa`, which must be supported by the running CPU
+  const Table& table(Isa isa);
+  // the kernels of best_isa(), resolved once
+  const Table& dispatch();
+
+  namespace detail
+  {
+    template<typename V>
+    std::size_t length(const V& v)
+    {
+      return static_cast<std::size_t>(v.size());
+    }
+  }  // namespace detail
+
+  template<typename Alloc, typename Trace>
+  long long sum(const Vector<int, Alloc, Trace>& x)
+  {
+    return dispatch().sum_i32(x.begin(), detail::length(x));
+  }
+  template<typename Alloc, typename Trace>
+  double sum(const Vector<double, Alloc, Trace>& x)
+  {
+    return dispatch().sum_f64(x.begin(), detail::length(x));
+  }
+
+  template<typename Alloc, typename Trace>
+  int min(const Vector<int, Alloc, Trace>& x)
+  {
+    return dispatch().min_i32(x.begin(), detail::length(x));
+  }
+  template<typename Alloc, typename Trace>
+  double min(const Vector<double, Alloc, Trace>& x)
+  {
+    return dispatch().min_f64(x.begin(), detail::length(x));
+  }
+
+  template<typename Alloc, typename Trace>
+  int max(const Vector<int, Alloc, Trace>& x)
+  {
+    return dispatch().max_i32(x.begin(), detail::length(x));
+  }
+  template<typename Alloc, typename Trace>
+  double max(const Vector<double, Alloc, Trace>& x)
+  {
+    return dispatch().max_f64(x.begin(), detail::length(x));
+  }
+
+  // x and y must have the same size
+  template<typename Alloc, typename Trace>
+  long long dot(const Vector<int, Alloc, Trace>& x, const Vector<int, Alloc, Trace>& y)
+  {
+    return dispatch().dot_i32(x.begin(), y.begin(), detail::length(x));
+  }
+  template<typename Alloc, typename Trace>
+  double dot(const Vector<double, Alloc, Trace>& x, const Vector<double, Alloc, Trace>& y)
+  {
+    return dispatch().dot_f64(x.begin(), y.begin(), detail::length(x));
+  }
+
+  // y = a * x + y, x and y must have the same size
+  template<typename Alloc, typename Trace>
+  void axpy(int a, const Vector<int, Alloc, Trace>& x, Vector<int, Alloc, Trace>& y)
+  {
+    dispatch().axpy_i32(a, x.begin(), y.begin(), detail::length(x));
+  }
+  template<typename Alloc, typename Trace>
+  void axpy(double a, const Vector<double, Alloc, Trace>& x, Vector<double, Alloc, Trace>& y)
+  {
+    dispatch().axpy_f64(a, x.begin(), y.begin(), detail::length(x));
+  }
+
+  template<typename Alloc, typename Trace>
+  void prefix_sum(Vector<int, Alloc, Trace>& x)
+  {
+    dispatch().prefix_sum_i32(x.begin(), detail::length(x));
+  }
+  template<typename Alloc, typename Trace>
+  void prefix_sum(Vector<double, Alloc, Trace>& x)
+  {
+    dispatch().prefix_sum_f64(x.begin(), detail::length(x));
+  }
+}  // namespace vector::kernels
+
+#endif  // VECTOR_KERNELS_H
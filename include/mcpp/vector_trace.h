@@ -0,0 +1,95 @@
+#ifndef VECTOR_TRACE_H
+#define VECTOR_TRACE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+
+// Compile-time tracing policies for the special member functions of vector::Vector.
+//
+// The policy is a template parameter of Vector, its `on` function is called from every copy/move constructor, copy/move
+// assignment and destructor. The default policy is selected by the `MCPP_VECTOR_TRACE` macro:
+//   0: NoTrace, the calls are empty inline functions and compile away (default in release builds)
+//   1: PutsTrace, print the name of the special member with puts (default in debug builds, i.e. `_DEBUG` is defined)
+//   2: CountingTrace, count the calls into per-thread counters
+#ifndef MCPP_VECTOR_TRACE
+#ifdef _DEBUG
+#define MCPP_VECTOR_TRACE 1
+#else
+#define MCPP_VECTOR_TRACE 0
+#endif
+#endif
+
+namespace vector
+{
+  enum class SpecialMember
+  {
+    CopyConstructor,
+    CopyAssignment,
+    MoveConstructor,
+    MoveAssignment,
+    Destructor,
+    Count
+  };
+
+  struct NoTrace
+  {
+    static void on(SpecialMember /*member*/)
+    {
+    }
+  };
+
+  // puts serializes on the stdio lock, so it dominates the cost of moving vectors in tight loops.
+  struct PutsTrace
+  {
+    static void on(SpecialMember member)
+    {
+      switch (member)
+      {
+        case SpecialMember::CopyConstructor: puts("copy constructor"); break;
+        case SpecialMember::CopyAssignment: puts("copy assignment"); break;
+        case SpecialMember::MoveConstructor: puts("move constructor"); break;
+        case SpecialMember::MoveAssignment: puts("move assignment"); break;
+        case SpecialMember::Destructor: puts("destructor"); break;
+        case SpecialMember::Count: break;
+      }
+    }
+  };
+
+  // thread_local counters: no atomic or lock on the hot path, a thread can only read its own counts.
+  struct CountingTrace
+  {
+    using Counters = std::array<std::size_t, static_cast<std::size_t>(SpecialMember::Count)>;
+
+    static void on(SpecialMember member)
+    {
+      ++counters()[static_cast<std::size_t>(member)];
+    }
+
+    static std::size_t count(SpecialMember member)
+    {
+      return counters()[static_cast<std::size_t>(member)];
+    }
+
+    static void reset()
+    {
+      counters().fill(0);
+    }
+
+    static Counters& counters()
+    {
+      thread_local Counters counters{};
+      return counters;
+    }
+  };
+
+#if MCPP_VECTOR_TRACE == 1
+  using DefaultTrace = PutsTrace;
+#elif MCPP_VECTOR_TRACE == 2
+  using DefaultTrace = CountingTrace;
+#else
+  using DefaultTrace = NoTrace;
+#endif
+}  // namespace vector
+
+#endif  // VECTOR_TRACE_H
@@ -0,0 +1,180 @@
+#include "mcpp/epoch.h"
+
+namespace mcpp
+{
+  namespace
+  {
+    // a thread tries to advance the epoch and frees what it can every kBatchSize retired objects
+    constexpr std::size_t kBatchSize = 64;
+    constexpr std::uint64_t kInCriticalSection = 1;
+  }  // namespace
+
+  // what a thread keeps in thread-local storage
+  struct EpochThreadState
+  {
+    EpochThreadState() : record(EpochDomain::global().acquire_record())
+    {
+    }
+
+    EpochThreadState(const EpochThreadState&) = delete;
+    EpochThreadState& operator=(const EpochThreadState&) = delete;
+
+    // give the record back to the domain, and the objects that are not old enough yet to the next collect of another thread
+    ~EpochThreadState()
+    {
+      EpochDomain& domain = EpochDomain::global();
+      record->state.store(0, std::memory_order_release);
+      record->active.store(false, std::memory_order_release);
+      if (!retired.empty())
+      {
+        domain.try_advance();
+        domain.collect(*this);
+      }
+      if (!retired.empty())
+      {
+        std::lock_guard<std::mutex> lock(domain.orphans_lock_);
+        domain.orphans_.insert(domain.orphans_.end(), retired.begin(), retired.end());
+      }
+    }
+
+    detail::EpochRecord* record;
+    std::size_t nesting{ 0 };
+    std::vector<EpochDomain::Retired> retired;
+    std::size_t retired_since_collect{ 0 };
+    // scratch buffer of collect
+    std::vector<EpochDomain::Retired> candidates;
+    bool collecting{ false };
+  };
+
+  namespace
+  {
+    EpochThreadState& this_thread_state()
+    {
+      thread_local EpochThreadState state;
+      return state;
+    }
+  }  // namespace
+
+  EpochDomain& EpochDomain::global()
+  {
+    static auto* domain = new EpochDomain;
+    return *domain;
+  }
+
+  detail::EpochRecord* EpochDomain::acquire_record()
+  {
+    for (detail::EpochRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+      bool active = false;
+      if (!record->active.load(std::memory_order_relaxed) &&
+          record->active.compare_exchange_strong(active, true, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return record;
+      }
+    }
+    auto* record = new detail::EpochRecord;
+    record->active.store(true, std::memory_order_relaxed);
+    record->next = records_.load(std::memory_order_relaxed);
+    while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return record;
+  }
+
+  void EpochDomain::push_retired(Retired retired)
+  {
+    EpochThreadState& state = this_thread_state();
+    // the unlink must be visible before we read the epoch: a reader that enters a critical section in a later epoch
+    // cannot reach the object
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    retired.epoch = epoch_.load(std::memory_order_relaxed);
+    state.retired.push_back(retired);
+    if (++state.retired_since_collect >= kBatchSize && !state.collecting)
+    {
+      state.retired_since_collect = 0;
+      try_advance();
+      collect(state);
+    }
+  }
+
+  void EpochDomain::reclaim()
+  {
+    EpochThreadState& state = this_thread_state();
+    if (!state.collecting)
+    {
+      try_advance();
+      collect(state);
+    }
+  }
+
+  std::uint64_t EpochDomain::try_advance()
+  {
+    std::uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+    // pairs with the fence of EpochGuard: either we see that a thread entered a critical section, or it sees the objects
+    // retired before as unlinked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (detail::EpochRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+      // acquire: the critical sections that ended before the state we read happen before the advance
+      std::uint64_t state = record->state.load(std::memory_order_acquire);
+      if ((state & kInCriticalSection) != 0 && (state >> 1) != epoch)
+      {
+        return epoch;
+      }
+    }
+    if (epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_release, std::memory_order_relaxed))
+    {
+      return epoch + 1;
+    }
+    return epoch;
+  }
+
+  void EpochDomain::collect(EpochThreadState& state)
+  {
+    // a deleter may retire more objects: they go to the thread's list, which is not the one we iterate over
+    state.collecting = true;
+    std::vector<Retired>& candidates = state.candidates;
+    candidates.swap(state.retired);
+    {
+      std::lock_guard<std::mutex> lock(orphans_lock_);
+      candidates.insert(candidates.end(), orphans_.begin(), orphans_.end());
+      orphans_.clear();
+    }
+    const std::uint64_t epoch = epoch_.load(std::memory_order_acquire);
+    for (const Retired& object : candidates)
+    {
+      if (object.epoch + 2 <= epoch)
+      {
+        object.deleter(object.ptr);
+      }
+      else
+      {
+        state.retired.push_back(object);
+      }
+    }
+    candidates.clear();
+    state.collecting = false;
+  }
+
+  EpochGuard::EpochGuard() : state_(this_thread_state())
+  {
+    if (state_.nesting++ == 0)
+    {
+      EpochDomain& domain = EpochDomain::global();
+      std::uint64_t epoch = domain.epoch_.load(std::memory_order_relaxed);
+      // release, like the store at the end: an advance that reads the new state also sees the end of the previous
+      // critical section
+      state_.record->state.store((epoch << 1) | kInCriticalSection, std::memory_order_release);
+      // the one fence of the critical section, the announcement must be visible before we read any shared object
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  EpochGuard::~EpochGuard()
+  {
+    if (--state_.nesting == 0)
+    {
+      state_.record->state.store(0, std::memory_order_release);
+    }
+  }
+}  // namespace mcpp
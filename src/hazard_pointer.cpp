@@ -0,0 +1,166 @@
+#include "mcpp/hazard_pointer.h"
+
+#include <algorithm>
+
+namespace mcpp
+{
+  namespace
+  {
+    // scan once a thread retired kScanFactor objects per slot, but not for a handful of objects
+    constexpr std::size_t kScanFactor = 2;
+    constexpr std::size_t kMinScanThreshold = 64;
+    // the free slots a thread keeps for its next hazard pointers
+    constexpr std::size_t kCachedSlots = 8;
+  }  // namespace
+
+  // what a thread keeps in thread-local storage
+  struct HazardThreadState
+  {
+    HazardThreadState() = default;
+    HazardThreadState(const HazardThreadState&) = delete;
+    HazardThreadState& operator=(const HazardThreadState&) = delete;
+
+    // give the slots back to the domain, and the objects that are still protected to the next scan of another thread
+    ~HazardThreadState()
+    {
+      HazardPointerDomain& domain = HazardPointerDomain::global();
+      for (detail::HazardSlot* slot : free_slots)
+      {
+        slot->active.store(false, std::memory_order_release);
+      }
+      if (!retired.empty())
+      {
+        domain.scan(*this);
+      }
+      if (!retired.empty())
+      {
+        std::lock_guard<std::mutex> lock(domain.orphans_lock_);
+        domain.orphans_.insert(domain.orphans_.end(), retired.begin(), retired.end());
+      }
+    }
+
+    std::vector<HazardPointerDomain::Retired> retired;
+    std::vector<detail::HazardSlot*> free_slots;  // still marked active
+    // scratch buffers of the scans
+    std::vector<HazardPointerDomain::Retired> candidates;
+    std::vector<const void*> hazards;
+    bool scanning{ false };
+  };
+
+  namespace
+  {
+    HazardThreadState& this_thread_state()
+    {
+      thread_local HazardThreadState state;
+      return state;
+    }
+  }  // namespace
+
+  HazardPointerDomain& HazardPointerDomain::global()
+  {
+    static auto* domain = new HazardPointerDomain;
+    return *domain;
+  }
+
+  detail::HazardSlot* HazardPointerDomain::acquire_slot()
+  {
+    HazardThreadState& state = this_thread_state();
+    if (!state.free_slots.empty())
+    {
+      detail::HazardSlot* slot = state.free_slots.back();
+      state.free_slots.pop_back();
+      return slot;
+    }
+    // take an inactive slot, left by an exited thread or released by a thread with enough cached ones
+    for (detail::HazardSlot* slot = slots_.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+    {
+      bool active = false;
+      if (!slot->active.load(std::memory_order_relaxed) &&
+          slot->active.compare_exchange_strong(active, true, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return slot;
+      }
+    }
+    auto* slot = new detail::HazardSlot;
+    slot->active.store(true, std::memory_order_relaxed);
+    slot->next = slots_.load(std::memory_order_relaxed);
+    while (!slots_.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    slot_count_.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+  }
+
+  void HazardPointerDomain::release_slot(detail::HazardSlot* slot)
+  {
+    slot->ptr.store(nullptr, std::memory_order_release);
+    HazardThreadState& state = this_thread_state();
+    if (state.free_slots.size() < kCachedSlots)
+    {
+      state.free_slots.push_back(slot);
+      return;
+    }
+    slot->active.store(false, std::memory_order_release);
+  }
+
+  void HazardPointerDomain::push_retired(Retired retired)
+  {
+    HazardThreadState& state = this_thread_state();
+    state.retired.push_back(retired);
+    if (state.retired.size() >= std::max(kMinScanThreshold, kScanFactor * slot_count()) && !state.scanning)
+    {
+      scan(state);
+    }
+  }
+
+  void HazardPointerDomain::reclaim()
+  {
+    HazardThreadState& state = this_thread_state();
+    if (!state.scanning)
+    {
+      scan(state);
+    }
+  }
+
+  void HazardPointerDomain::scan(HazardThreadState& state)
+  {
+    // a deleter may retire more objects: they go to the thread's list, which is not the one we iterate over, and wait for
+    // the next scan
+    state.scanning = true;
+    std::vector<Retired>& candidates = state.candidates;
+    candidates.swap(state.retired);
+    {
+      std::lock_guard<std::mutex> lock(orphans_lock_);
+      candidates.insert(candidates.end(), orphans_.begin(), orphans_.end());
+      orphans_.clear();
+    }
+
+    // pairs with the fence of try_protect: the objects were unlinked before, so a reader that protects one of them after
+    // this point fails its check of the source
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<const void*>& hazards = state.hazards;
+    hazards.clear();
+    for (detail::HazardSlot* slot = slots_.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+    {
+      if (const void* ptr = slot->ptr.load(std::memory_order_acquire))
+      {
+        hazards.push_back(ptr);
+      }
+    }
+    std::sort(hazards.begin(), hazards.end());
+
+    for (const Retired& object : candidates)
+    {
+      if (std::binary_search(hazards.begin(), hazards.end(), static_cast<const void*>(object.ptr)))
+      {
+        state.retired.push_back(object);
+      }
+      else
+      {
+        object.deleter(object.ptr);
+      }
+    }
+    candidates.clear();
+    state.scanning = false;
+  }
+}  // namespace mcpp
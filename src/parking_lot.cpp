@@ -0,0 +1,526 @@
+#include "mcpp/parking_lot.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#if !defined(MCPP_PARKING_LOT_FUTEX) && defined(__linux__)
+#define MCPP_PARKING_LOT_FUTEX 1
+#endif
+
+#if MCPP_PARKING_LOT_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#else
+#include <condition_variable>
+#endif
+
+namespace mcpp
+{
+  namespace
+  {
+#if MCPP_PARKING_LOT_FUTEX
+    // the thread sleeps on its own futex word: 1 while parked, reset to 0 by the unparker
+    class Parker
+    {
+     public:
+      void prepare()
+      {
+        word_.store(1, std::memory_order_relaxed);
+      }
+
+      // wait until unparked (true) or until the timeout (false)
+      bool wait_until(ParkingLot::Clock::time_point timeout)
+      {
+        // FUTEX_WAIT returns with EINTR when a signal interrupts it, with EAGAIN when the word is no longer 1, and may
+        // return for no reason at all: the loop checks the word again every time, so none of them can lose a wakeup, and
+        // it computes the remaining time again, so a stream of signals cannot extend the timeout either
+        while (word_.load(std::memory_order_acquire) != 0)
+        {
+          timespec relative{};
+          const timespec* wait_for = nullptr;
+          if (timeout != ParkingLot::Clock::time_point::max())
+          {
+            auto now = ParkingLot::Clock::now();
+            if (now >= timeout)
+            {
+              return false;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - now);
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+            relative.tv_sec = seconds.count();
+            relative.tv_nsec = (remaining - seconds).count();
+            wait_for = &relative;
+          }
+          futex(FUTEX_WAIT_PRIVATE, 1, wait_for);
+        }
+        return true;
+      }
+
+      void unpark()
+      {
+        word_.store(0, std::memory_order_release);
+        // the thread may already have seen the 0 and exited: then the wake hits a dead (or reused) word, which at worst is a
+        // spurious wakeup for whoever waits on it now, and every waiter tolerates those
+        futex(FUTEX_WAKE_PRIVATE, 1, nullptr);
+      }
+
+     private:
+      // futex(2) has no glibc wrapper
+      void futex(int op, std::uint32_t value, const timespec* timeout)
+      {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word_), op, value, timeout, nullptr, 0);  // NOLINT
+      }
+
+      static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "a futex word is 32 bits");
+      std::atomic<std::uint32_t> word_{ 0 };
+    };
+#else
+    // the thread sleeps on its own condition variable, `parked` is reset under the mutex by the unparker
+    class Parker
+    {
+     public:
+      void prepare()
+      {
+        std::lock_guard<std::mutex> lock(lock_);
+        parked_ = true;
+      }
+
+      // wait until unparked (true) or until the timeout (false)
+      bool wait_until(ParkingLot::Clock::time_point timeout)
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        while (parked_)
+        {
+          if (timeout == ParkingLot::Clock::time_point::max())
+          {
+            cv_.wait(lock);
+          }
+          else if (cv_.wait_until(lock, timeout) == std::cv_status::timeout)
+          {
+            return !parked_;
+          }
+        }
+        return true;
+      }
+
+      void unpark()
+      {
+        // notify under the lock: once it sees parked reset, the thread may return and exit
+        std::lock_guard<std::mutex> lock(lock_);
+        parked_ = false;
+        cv_.notify_one();
+      }
+
+     private:
+      std::mutex lock_;
+      std::condition_variable cv_;
+      bool parked_{};
+    };
+#endif
+
+    // one per thread, in thread-local storage: the node of the bucket queues and what the thread sleeps on
+    struct ThreadData
+    {
+      ThreadData();
+      ThreadData(const ThreadData&) = delete;
+      ThreadData& operator=(const ThreadData&) = delete;
+      ~ThreadData();
+
+      Parker parker;
+      // the address the thread is parked on, changed only under the bucket locks (requeue moves the thread to another
+      // address), atomic because a thread that times out reads it to find its bucket
+      std::atomic<const void*> address{ nullptr };
+      ThreadData* next_in_queue{};
+    };
+
+    struct alignas(64) Bucket
+    {
+      std::mutex lock;
+      ThreadData* head{};
+      ThreadData* tail{};
+
+      void enqueue(ThreadData* thread)
+      {
+        thread->next_in_queue = nullptr;
+        if (tail == nullptr)
+        {
+          head = thread;
+        }
+        else
+        {
+          tail->next_in_queue = thread;
+        }
+        tail = thread;
+      }
+
+      // unlink the node after `prev` (the head if prev is nullptr)
+      void unlink(ThreadData* prev, ThreadData* thread)
+      {
+        (prev == nullptr ? head : prev->next_in_queue) = thread->next_in_queue;
+        if (tail == thread)
+        {
+          tail = prev;
+        }
+        thread->next_in_queue = nullptr;
+      }
+
+      // remove the first thread parked on `address`, and tell whether another one is still queued behind it
+      ThreadData* dequeue(const void* address, bool& more)
+      {
+        ThreadData* prev = nullptr;
+        for (ThreadData* thread = head; thread != nullptr; prev = thread, thread = thread->next_in_queue)
+        {
+          if (thread->address.load(std::memory_order_relaxed) == address)
+          {
+            ThreadData* next = thread->next_in_queue;
+            unlink(prev, thread);
+            more = false;
+            for (; next != nullptr; next = next->next_in_queue)
+            {
+              if (next->address.load(std::memory_order_relaxed) == address)
+              {
+                more = true;
+                break;
+              }
+            }
+            return thread;
+          }
+        }
+        more = false;
+        return nullptr;
+      }
+
+      // remove all the threads parked on `address`, returned in queue order as a list chained through next_in_queue
+      ThreadData* dequeue_all(const void* address)
+      {
+        ThreadData* first = nullptr;
+        ThreadData* last = nullptr;
+        ThreadData* prev = nullptr;
+        for (ThreadData* thread = head; thread != nullptr;)
+        {
+          ThreadData* next = thread->next_in_queue;
+          if (thread->address.load(std::memory_order_relaxed) == address)
+          {
+            unlink(prev, thread);
+            (last == nullptr ? first : last->next_in_queue) = thread;
+            last = thread;
+          }
+          else
+          {
+            prev = thread;
+          }
+          thread = next;
+        }
+        return first;
+      }
+
+      bool remove(ThreadData* target)
+      {
+        ThreadData* prev = nullptr;
+        for (ThreadData* thread = head; thread != nullptr; prev = thread, thread = thread->next_in_queue)
+        {
+          if (thread == target)
+          {
+            unlink(prev, thread);
+            return true;
+          }
+        }
+        return false;
+      }
+    };
+
+    struct Hashtable
+    {
+      Hashtable(std::size_t n, Hashtable* prev) : size(n), buckets(new Bucket[n]), previous(prev)
+      {
+      }
+
+      Bucket& bucket(const void* address) const
+      {
+        auto h = reinterpret_cast<std::uintptr_t>(address);  // NOLINT
+        h = (h >> 4U) * 0x9e3779b97f4a7c15ULL;
+        return buckets[(h >> 32U) & (size - 1)];
+      }
+
+      std::size_t size;  // a power of two
+      std::unique_ptr<Bucket[]> buckets;
+      // the tables are never freed: a thread may still be blocked on the lock of an old bucket
+      Hashtable* previous;
+    };
+
+    // at least kMaxLoadFactor buckets per thread, so that the queues stay short
+    constexpr std::size_t kMaxLoadFactor = 3;
+    constexpr std::size_t kInitialSize = 64;
+
+    std::atomic<Hashtable*> g_table{ nullptr };
+    std::atomic<std::size_t> g_num_threads{ 0 };
+
+    Hashtable* current_table()
+    {
+      Hashtable* table = g_table.load(std::memory_order_acquire);
+      if (table != nullptr)
+      {
+        return table;
+      }
+      auto* fresh = new Hashtable(kInitialSize, nullptr);
+      if (g_table.compare_exchange_strong(table, fresh, std::memory_order_acq_rel))
+      {
+        return fresh;
+      }
+      delete fresh;
+      return table;
+    }
+
+    // grow the table to fit `threads` threads: lock every bucket of the current table, move the queued threads to a bigger
+    // table and publish it. A thread that locks a bucket of the old table afterwards sees that it is not current and retries.
+    void ensure_size(std::size_t threads)
+    {
+      for (;;)
+      {
+        Hashtable* old = current_table();
+        if (old->size >= threads * kMaxLoadFactor)
+        {
+          return;
+        }
+        for (std::size_t i = 0; i < old->size; ++i)
+        {
+          old->buckets[i].lock.lock();
+        }
+        const bool is_current = old == g_table.load(std::memory_order_acquire);
+        if (is_current)
+        {
+          std::size_t new_size = old->size;
+          while (new_size < threads * kMaxLoadFactor * 2)
+          {
+            new_size *= 2;
+          }
+          auto* table = new Hashtable(new_size, old);
+          // bucket by bucket in queue order, so the threads parked on one address stay in FIFO order
+          for (std::size_t i = 0; i < old->size; ++i)
+          {
+            Bucket& bucket = old->buckets[i];
+            for (ThreadData* thread = bucket.head; thread != nullptr;)
+            {
+              ThreadData* next = thread->next_in_queue;
+              table->bucket(thread->address.load(std::memory_order_relaxed)).enqueue(thread);
+              thread = next;
+            }
+            bucket.head = nullptr;
+            bucket.tail = nullptr;
+          }
+          g_table.store(table, std::memory_order_release);
+        }
+        for (std::size_t i = 0; i < old->size; ++i)
+        {
+          old->buckets[i].lock.unlock();
+        }
+        if (is_current)
+        {
+          return;
+        }
+      }
+    }
+
+    // the locked bucket of `address` in the current table
+    Bucket& lock_bucket(const void* address)
+    {
+      for (;;)
+      {
+        Hashtable* table = current_table();
+        Bucket& bucket = table->bucket(address);
+        bucket.lock.lock();
+        if (table == g_table.load(std::memory_order_acquire))
+        {
+          return bucket;
+        }
+        bucket.lock.unlock();
+      }
+    }
+
+    // the locked buckets of two addresses in the current table, locked once if they are the same bucket. The buckets are
+    // locked in address order, the order in which ensure_size locks them all, so that nobody can deadlock.
+    std::pair<Bucket*, Bucket*> lock_buckets(const void* a, const void* b)
+    {
+      for (;;)
+      {
+        Hashtable* table = current_table();
+        Bucket* first = &table->bucket(a);
+        Bucket* second = &table->bucket(b);
+        Bucket* low = std::less<Bucket*>()(first, second) ? first : second;
+        Bucket* high = low == first ? second : first;
+        low->lock.lock();
+        if (high != low)
+        {
+          high->lock.lock();
+        }
+        if (table == g_table.load(std::memory_order_acquire))
+        {
+          return { first, second };
+        }
+        if (high != low)
+        {
+          high->lock.unlock();
+        }
+        low->lock.unlock();
+      }
+    }
+
+    void unlock_buckets(std::pair<Bucket*, Bucket*> buckets)
+    {
+      if (buckets.second != buckets.first)
+      {
+        buckets.second->lock.unlock();
+      }
+      buckets.first->lock.unlock();
+    }
+
+    // wake up the threads of a list chained through next_in_queue, after they left the queues, and count them
+    std::size_t unpark_list(ThreadData* first)
+    {
+      std::size_t count = 0;
+      while (first != nullptr)
+      {
+        // read the next one before: a woken thread may return and park again
+        ThreadData* thread = first;
+        first = thread->next_in_queue;
+        thread->parker.unpark();
+        ++count;
+      }
+      return count;
+    }
+
+    ThreadData::ThreadData()
+    {
+      ensure_size(g_num_threads.fetch_add(1) + 1);
+    }
+
+    ThreadData::~ThreadData()
+    {
+      g_num_threads.fetch_sub(1);
+    }
+
+    ThreadData& this_thread_data()
+    {
+      thread_local ThreadData data;
+      return data;
+    }
+  }  // namespace
+
+  bool ParkingLot::parkConditionally(
+      const void* address,
+      FunctionRef<bool()> validation,
+      FunctionRef<void()> before_sleep,
+      Clock::time_point timeout)
+  {
+    ThreadData& me = this_thread_data();
+    {
+      Bucket& bucket = lock_bucket(address);
+      std::lock_guard<std::mutex> bucket_lock(bucket.lock, std::adopt_lock);
+      if (!validation())
+      {
+        return false;
+      }
+      me.address.store(address, std::memory_order_relaxed);
+      me.parker.prepare();
+      bucket.enqueue(&me);
+    }
+
+    before_sleep();
+
+    if (me.parker.wait_until(timeout))
+    {
+      return true;
+    }
+
+    // timed out: leave the queue, unless an unparker has dequeued us in the meantime. We may have been requeued to
+    // another address, so look for the bucket of our current one.
+    bool removed = false;
+    for (;;)
+    {
+      const void* current = me.address.load(std::memory_order_relaxed);
+      Bucket& bucket = lock_bucket(current);
+      std::lock_guard<std::mutex> bucket_lock(bucket.lock, std::adopt_lock);
+      if (me.address.load(std::memory_order_relaxed) == current)
+      {
+        removed = bucket.remove(&me);
+        break;
+      }
+    }
+    if (removed)
+    {
+      return false;
+    }
+    // the unparker still has to wake us up, wait for it so that it is done with our ThreadData
+    me.parker.wait_until(Clock::time_point::max());
+    return true;
+  }
+
+  void ParkingLot::unparkOne(const void* address, FunctionRef<void(bool did_unpark, bool queue_empty)> callback)
+  {
+    ThreadData* thread = nullptr;
+    {
+      Bucket& bucket = lock_bucket(address);
+      std::lock_guard<std::mutex> bucket_lock(bucket.lock, std::adopt_lock);
+      bool more = false;
+      thread = bucket.dequeue(address, more);
+      callback(thread != nullptr, !more);
+    }
+    if (thread != nullptr)
+    {
+      thread->parker.unpark();
+    }
+  }
+
+  std::size_t ParkingLot::unparkAll(const void* address)
+  {
+    ThreadData* first = nullptr;
+    {
+      Bucket& bucket = lock_bucket(address);
+      std::lock_guard<std::mutex> bucket_lock(bucket.lock, std::adopt_lock);
+      first = bucket.dequeue_all(address);
+    }
+    return unpark_list(first);
+  }
+
+  std::size_t ParkingLot::unparkAndRequeue(const void* from, const void* to, std::size_t wake_count)
+  {
+    ThreadData* woken = nullptr;
+    {
+      auto buckets = lock_buckets(from, to);
+      ThreadData* thread = buckets.first->dequeue_all(from);
+      // keep the first wake_count threads chained, move the others to the queue of `to` in the same order
+      ThreadData* last_woken = nullptr;
+      for (std::size_t i = 0; i < wake_count && thread != nullptr; ++i)
+      {
+        (last_woken == nullptr ? woken : last_woken->next_in_queue) = thread;
+        last_woken = thread;
+        thread = thread->next_in_queue;
+      }
+      if (last_woken != nullptr)
+      {
+        last_woken->next_in_queue = nullptr;
+      }
+      while (thread != nullptr)
+      {
+        ThreadData* next = thread->next_in_queue;
+        thread->address.store(to, std::memory_order_relaxed);
+        buckets.second->enqueue(thread);
+        thread = next;
+      }
+      unlock_buckets(buckets);
+    }
+    return unpark_list(woken);
+  }
+
+  std::size_t ParkingLot::bucketCount()
+  {
+    return current_table()->size;
+  }
+}  // namespace mcpp
@@ -0,0 +1,617 @@
+#include "mcpp/vector_kernels.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MCPP_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define MCPP_KERNELS_X86 0
+#endif
+
+namespace vector::kernels
+{
+  namespace
+  {
+    // int arithmetic that wraps around on overflow instead of being undefined behavior
+    int wrap_add(int a, int b)
+    {
+      return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b));
+    }
+    int wrap_mul(int a, int b)
+    {
+      return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b));
+    }
+
+    //
+    // scalar fallback
+    //
+
+    long long sum_i32_scalar(const int* x, std::size_t n)
+    {
+      long long s = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        s += x[i];
+      }
+      return s;
+    }
+
+    double sum_f64_scalar(const double* x, std::size_t n)
+    {
+      double s = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        s += x[i];
+      }
+      return s;
+    }
+
+    int min_i32_scalar(const int* x, std::size_t n)
+    {
+      int m = std::numeric_limits<int>::max();
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        m = std::min(m, x[i]);
+      }
+      return m;
+    }
+
+    int max_i32_scalar(const int* x, std::size_t n)
+    {
+      int m = std::numeric_limits<int>::min();
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        m = std::max(m, x[i]);
+      }
+      return m;
+    }
+
+    double min_f64_scalar(const double* x, std::size_t n)
+    {
+      double m = std::numeric_limits<double>::infinity();
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        m = std::min(m, x[i]);
+      }
+      return m;
+    }
+
+    double max_f64_scalar(const double* x, std::size_t n)
+    {
+      double m = -std::numeric_limits<double>::infinity();
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        m = std::max(m, x[i]);
+      }
+      return m;
+    }
+
+    long long dot_i32_scalar(const int* x, const int* y, std::size_t n)
+    {
+      long long s = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        s += static_cast<long long>(x[i]) * y[i];
+      }
+      return s;
+    }
+
+    double dot_f64_scalar(const double* x, const double* y, std::size_t n)
+    {
+      double s = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        s += x[i] * y[i];
+      }
+      return s;
+    }
+
+    void axpy_i32_scalar(int a, const int* x, int* y, std::size_t n)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        y[i] = wrap_add(wrap_mul(a, x[i]), y[i]);
+      }
+    }
+
+    void axpy_f64_scalar(double a, const double* x, double* y, std::size_t n)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        y[i] = a * x[i] + y[i];
+      }
+    }
+
+    void prefix_sum_i32_scalar(int* x, std::size_t n)
+    {
+      for (std::size_t i = 1; i < n; ++i)
+      {
+        x[i] = wrap_add(x[i - 1], x[i]);
+      }
+    }
+
+    void prefix_sum_f64_scalar(double* x, std::size_t n)
+    {
+      for (std::size_t i = 1; i < n; ++i)
+      {
+        x[i] += x[i - 1];
+      }
+    }
+
+    const Table kScalar{
+      sum_i32_scalar, sum_f64_scalar, min_i32_scalar, max_i32_scalar, min_f64_scalar,        max_f64_scalar,
+      dot_i32_scalar, dot_f64_scalar, axpy_i32_scalar, axpy_f64_scalar, prefix_sum_i32_scalar, prefix_sum_f64_scalar,
+    };
+
+#if MCPP_KERNELS_X86
+
+#define MCPP_SSE41 __attribute__((target("sse4.1")))
+#define MCPP_AVX2  __attribute__((target("avx2")))
+
+    //
+    // SSE4.1: 128-bit, 4 ints or 2 doubles per register
+    //
+
+    MCPP_SSE41 __m128i load128(const int* p)
+    {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));  // NOLINT
+    }
+    MCPP_SSE41 void store128(int* p, __m128i v)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);  // NOLINT
+    }
+    MCPP_SSE41 long long hsum_epi64(__m128i v)
+    {
+      return _mm_cvtsi128_si64(v) + _mm_extract_epi64(v, 1);
+    }
+    MCPP_SSE41 double hsum_pd(__m128d v)
+    {
+      return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+
+    MCPP_SSE41 long long sum_i32_sse41(const int* x, std::size_t n)
+    {
+      __m128i acc = _mm_setzero_si128();
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128i v = load128(x + i);
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(v));
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+      }
+      return hsum_epi64(acc) + sum_i32_scalar(x + i, n - i);
+    }
+
+    MCPP_SSE41 double sum_f64_sse41(const double* x, std::size_t n)
+    {
+      __m128d acc0 = _mm_setzero_pd();
+      __m128d acc1 = _mm_setzero_pd();
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(x + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(x + i + 2));
+      }
+      return hsum_pd(_mm_add_pd(acc0, acc1)) + sum_f64_scalar(x + i, n - i);
+    }
+
+    MCPP_SSE41 int min_i32_sse41(const int* x, std::size_t n)
+    {
+      __m128i acc = _mm_set1_epi32(std::numeric_limits<int>::max());
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc = _mm_min_epi32(acc, load128(x + i));
+      }
+      acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+      return std::min(_mm_cvtsi128_si32(acc), min_i32_scalar(x + i, n - i));
+    }
+
+    MCPP_SSE41 int max_i32_sse41(const int* x, std::size_t n)
+    {
+      __m128i acc = _mm_set1_epi32(std::numeric_limits<int>::min());
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc = _mm_max_epi32(acc, load128(x + i));
+      }
+      acc = _mm_max_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc = _mm_max_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+      return std::max(_mm_cvtsi128_si32(acc), max_i32_scalar(x + i, n - i));
+    }
+
+    MCPP_SSE41 double min_f64_sse41(const double* x, std::size_t n)
+    {
+      __m128d acc = _mm_set1_pd(std::numeric_limits<double>::infinity());
+      std::size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+        acc = _mm_min_pd(acc, _mm_loadu_pd(x + i));
+      }
+      acc = _mm_min_sd(acc, _mm_unpackhi_pd(acc, acc));
+      return std::min(_mm_cvtsd_f64(acc), min_f64_scalar(x + i, n - i));
+    }
+
+    MCPP_SSE41 double max_f64_sse41(const double* x, std::size_t n)
+    {
+      __m128d acc = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+      std::size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+        acc = _mm_max_pd(acc, _mm_loadu_pd(x + i));
+      }
+      acc = _mm_max_sd(acc, _mm_unpackhi_pd(acc, acc));
+      return std::max(_mm_cvtsd_f64(acc), max_f64_scalar(x + i, n - i));
+    }
+
+    MCPP_SSE41 long long dot_i32_sse41(const int* x, const int* y, std::size_t n)
+    {
+      __m128i acc = _mm_setzero_si128();
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128i a = load128(x + i);
+        __m128i b = load128(y + i);
+        // _mm_mul_epi32 multiplies the (signed) low int of each 64-bit lane into a 64-bit product
+        acc = _mm_add_epi64(acc, _mm_mul_epi32(a, b));
+        acc = _mm_add_epi64(acc, _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)));
+      }
+      return hsum_epi64(acc) + dot_i32_scalar(x + i, y + i, n - i);
+    }
+
+    MCPP_SSE41 double dot_f64_sse41(const double* x, const double* y, std::size_t n)
+    {
+      __m128d acc0 = _mm_setzero_pd();
+      __m128d acc1 = _mm_setzero_pd();
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+      }
+      return hsum_pd(_mm_add_pd(acc0, acc1)) + dot_f64_scalar(x + i, y + i, n - i);
+    }
+
+    MCPP_SSE41 void axpy_i32_sse41(int a, const int* x, int* y, std::size_t n)
+    {
+      __m128i va = _mm_set1_epi32(a);
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        store128(y + i, _mm_add_epi32(_mm_mullo_epi32(va, load128(x + i)), load128(y + i)));
+      }
+      axpy_i32_scalar(a, x + i, y + i, n - i);
+    }
+
+    MCPP_SSE41 void axpy_f64_sse41(double a, const double* x, double* y, std::size_t n)
+    {
+      __m128d va = _mm_set1_pd(a);
+      std::size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(x + i)), _mm_loadu_pd(y + i)));
+      }
+      axpy_f64_scalar(a, x + i, y + i, n - i);
+    }
+
+    // in-register scan: add the vector shifted by 1 then by 2 lanes, then the running total of the previous registers.
+    MCPP_SSE41 void prefix_sum_i32_sse41(int* x, std::size_t n)
+    {
+      __m128i carry = _mm_setzero_si128();
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128i v = load128(x + i);
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, carry);
+        store128(x + i, v);
+        carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+      }
+      if (i > 0 && i < n)
+      {
+        x[i] = wrap_add(x[i - 1], x[i]);
+      }
+      prefix_sum_i32_scalar(x + i, n - i);
+    }
+
+    MCPP_SSE41 void prefix_sum_f64_sse41(double* x, std::size_t n)
+    {
+      __m128d carry = _mm_setzero_pd();
+      std::size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+        __m128d v = _mm_loadu_pd(x + i);
+        v = _mm_add_pd(v, _mm_unpacklo_pd(_mm_setzero_pd(), v));
+        v = _mm_add_pd(v, carry);
+        _mm_storeu_pd(x + i, v);
+        carry = _mm_unpackhi_pd(v, v);
+      }
+      if (i > 0 && i < n)
+      {
+        x[i] += x[i - 1];
+      }
+      prefix_sum_f64_scalar(x + i, n - i);
+    }
+
+    const Table kSse41{
+      sum_i32_sse41, sum_f64_sse41, min_i32_sse41,  max_i32_sse41,  min_f64_sse41,        max_f64_sse41,
+      dot_i32_sse41, dot_f64_sse41, axpy_i32_sse41, axpy_f64_sse41, prefix_sum_i32_sse41, prefix_sum_f64_sse41,
+    };
+
+    //
+    // AVX2: 256-bit, 8 ints or 4 doubles per register
+    //
+
+    MCPP_AVX2 __m256i load256(const int* p)
+    {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));  // NOLINT
+    }
+    MCPP_AVX2 void store256(int* p, __m256i v)
+    {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);  // NOLINT
+    }
+    MCPP_AVX2 long long hsum_epi64(__m256i v)
+    {
+      __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+      return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+    }
+    MCPP_AVX2 double hsum_pd(__m256d v)
+    {
+      __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+      return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+
+    MCPP_AVX2 long long sum_i32_avx2(const int* x, std::size_t n)
+    {
+      __m256i acc0 = _mm256_setzero_si256();
+      __m256i acc1 = _mm256_setzero_si256();
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        __m256i v = load256(x + i);
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+      }
+      return hsum_epi64(_mm256_add_epi64(acc0, acc1)) + sum_i32_scalar(x + i, n - i);
+    }
+
+    MCPP_AVX2 double sum_f64_avx2(const double* x, std::size_t n)
+    {
+      __m256d acc0 = _mm256_setzero_pd();
+      __m256d acc1 = _mm256_setzero_pd();
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x + i + 4));
+      }
+      return hsum_pd(_mm256_add_pd(acc0, acc1)) + sum_f64_scalar(x + i, n - i);
+    }
+
+    MCPP_AVX2 int min_i32_avx2(const int* x, std::size_t n)
+    {
+      __m256i acc = _mm256_set1_epi32(std::numeric_limits<int>::max());
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc = _mm256_min_epi32(acc, load256(x + i));
+      }
+      __m128i m = _mm_min_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+      m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+      m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+      return std::min(_mm_cvtsi128_si32(m), min_i32_scalar(x + i, n - i));
+    }
+
+    MCPP_AVX2 int max_i32_avx2(const int* x, std::size_t n)
+    {
+      __m256i acc = _mm256_set1_epi32(std::numeric_limits<int>::min());
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc = _mm256_max_epi32(acc, load256(x + i));
+      }
+      __m128i m = _mm_max_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+      m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+      m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+      return std::max(_mm_cvtsi128_si32(m), max_i32_scalar(x + i, n - i));
+    }
+
+    MCPP_AVX2 double min_f64_avx2(const double* x, std::size_t n)
+    {
+      __m256d acc = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc = _mm256_min_pd(acc, _mm256_loadu_pd(x + i));
+      }
+      __m128d m = _mm_min_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+      m = _mm_min_sd(m, _mm_unpackhi_pd(m, m));
+      return std::min(_mm_cvtsd_f64(m), min_f64_scalar(x + i, n - i));
+    }
+
+    MCPP_AVX2 double max_f64_avx2(const double* x, std::size_t n)
+    {
+      __m256d acc = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc = _mm256_max_pd(acc, _mm256_loadu_pd(x + i));
+      }
+      __m128d m = _mm_max_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+      m = _mm_max_sd(m, _mm_unpackhi_pd(m, m));
+      return std::max(_mm_cvtsd_f64(m), max_f64_scalar(x + i, n - i));
+    }
+
+    MCPP_AVX2 long long dot_i32_avx2(const int* x, const int* y, std::size_t n)
+    {
+      __m256i acc = _mm256_setzero_si256();
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        __m256i a = load256(x + i);
+        __m256i b = load256(y + i);
+        acc = _mm256_add_epi64(acc, _mm256_mul_epi32(a, b));
+        acc = _mm256_add_epi64(acc, _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)));
+      }
+      return hsum_epi64(acc) + dot_i32_scalar(x + i, y + i, n - i);
+    }
+
+    MCPP_AVX2 double dot_f64_avx2(const double* x, const double* y, std::size_t n)
+    {
+      __m256d acc0 = _mm256_setzero_pd();
+      __m256d acc1 = _mm256_setzero_pd();
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+      }
+      return hsum_pd(_mm256_add_pd(acc0, acc1)) + dot_f64_scalar(x + i, y + i, n - i);
+    }
+
+    MCPP_AVX2 void axpy_i32_avx2(int a, const int* x, int* y, std::size_t n)
+    {
+      __m256i va = _mm256_set1_epi32(a);
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        store256(y + i, _mm256_add_epi32(_mm256_mullo_epi32(va, load256(x + i)), load256(y + i)));
+      }
+      axpy_i32_scalar(a, x + i, y + i, n - i);
+    }
+
+    MCPP_AVX2 void axpy_f64_avx2(double a, const double* x, double* y, std::size_t n)
+    {
+      __m256d va = _mm256_set1_pd(a);
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_mul_pd(va, _mm256_loadu_pd(x + i)), _mm256_loadu_pd(y + i)));
+      }
+      axpy_f64_scalar(a, x + i, y + i, n - i);
+    }
+
+    // _mm256_slli_si256 shifts each 128-bit half separately, so scan the halves first, then add the last int of the low
+    // half to the high half.
+    MCPP_AVX2 void prefix_sum_i32_avx2(int* x, std::size_t n)
+    {
+      __m256i carry = _mm256_setzero_si256();
+      const __m256i last = _mm256_set1_epi32(7);
+      std::size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        __m256i v = load256(x + i);
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+        // [0, low half] then broadcast its last int inside each half: [0, 0, 0, 0, v3, v3, v3, v3]
+        __m256i low = _mm256_permute2x128_si256(v, v, 0x08);
+        v = _mm256_add_epi32(v, _mm256_shuffle_epi32(low, _MM_SHUFFLE(3, 3, 3, 3)));
+        v = _mm256_add_epi32(v, carry);
+        store256(x + i, v);
+        carry = _mm256_permutevar8x32_epi32(v, last);
+      }
+      if (i > 0 && i < n)
+      {
+        x[i] = wrap_add(x[i - 1], x[i]);
+      }
+      prefix_sum_i32_scalar(x + i, n - i);
+    }
+
+    MCPP_AVX2 void prefix_sum_f64_avx2(double* x, std::size_t n)
+    {
+      __m256d carry = _mm256_setzero_pd();
+      const __m256d zero = _mm256_setzero_pd();
+      std::size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m256d v = _mm256_loadu_pd(x + i);
+        // + [0, v0, v1, v2]
+        v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+        // + [0, 0, v0, v1]
+        v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+        v = _mm256_add_pd(v, carry);
+        _mm256_storeu_pd(x + i, v);
+        carry = _mm256_permute4x64_pd(v, _MM_SHUFFLE(3, 3, 3, 3));
+      }
+      if (i > 0 && i < n)
+      {
+        x[i] += x[i - 1];
+      }
+      prefix_sum_f64_scalar(x + i, n - i);
+    }
+
+    const Table kAvx2{
+      sum_i32_avx2, sum_f64_avx2, min_i32_avx2,  max_i32_avx2,  min_f64_avx2,        max_f64_avx2,
+      dot_i32_avx2, dot_f64_avx2, axpy_i32_avx2, axpy_f64_avx2, prefix_sum_i32_avx2, prefix_sum_f64_avx2,
+    };
+
+#undef MCPP_SSE41
+#undef MCPP_AVX2
+
+#endif  // MCPP_KERNELS_X86
+  }  // namespace
+
+  bool supported(Isa isa)
+  {
+    switch (isa)
+    {
+      case Isa::Scalar: return true;
+#if MCPP_KERNELS_X86
+      case Isa::Sse41: return __builtin_cpu_supports("sse4.1") != 0;
+      case Isa::Avx2: return __builtin_cpu_supports("avx2") != 0;
+#else
+      case Isa::Sse41: return false;
+      case Isa::Avx2: return false;
+#endif
+    }
+    return false;
+  }
+
+  Isa best_isa()
+  {
+    if (supported(Isa::Avx2))
+    {
+      return Isa::Avx2;
+    }
+    if (supported(Isa::Sse41))
+    {
+      return Isa::Sse41;
+    }
+    return Isa::Scalar;
+  }
+
+  const char* isa_name(Isa isa)
+  {
+    switch (isa)
+    {
+      case Isa::Scalar: return "scalar";
+      case Isa::Sse41: return "sse4.1";
+      case Isa::Avx2: return "avx2";
+    }
+    return "unknown";
+  }
+
+  const Table& table(Isa isa)
+  {
+#if MCPP_KERNELS_X86
+    switch (isa)
+    {
+      case Isa::Scalar: return kScalar;
+      case Isa::Sse41: return kSse41;
+      case Isa::Avx2: return kAvx2;
+    }
+#endif
+    (void)isa;
+    return kScalar;
+  }
+
+  const Table& dispatch()
+  {
+    static const Table& best = table(best_isa());
+    return best;
+  }
+}  // namespace vector::kernels
@@ -1,62 +1,245 @@
 #include <gtest/gtest.h>
 
-// NOLINTBEGIN
+#include "mcpp/limiter.h"
+
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
-#include <iostream>
-#include <mutex>
+#include <thread>
+#include <vector>
+
+using mcpp::FixedSizeLimiter;
+
+TEST(FixSizeLimiterTest, Const)  // NOLINT
+{
+  auto l = FixedSizeLimiter(10, 1000);
+  l.Request();
+  l.Request();
+  l.Release();
+  l.Release();
+}
+
+TEST(FixSizeLimiterTest, Timeout)  // NOLINT
+{
+  FixedSizeLimiter l(2, 10);
+  EXPECT_EQ(l.Request(), 0);
+  EXPECT_EQ(l.Request(), 0);
+  EXPECT_EQ(l.InUse(), 2U);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(l.Request(), 1);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(10));
+  l.Release();
+  EXPECT_EQ(l.Request(), 0);
+}
 
-/**
-  A fixed-size limiter.
-*/
-class FixedSizeLimiter
+TEST(FixSizeLimiterTest, WakesUpOnRelease)  // NOLINT
 {
- public:
-  FixedSizeLimiter() = default;
-  ~FixedSizeLimiter() = default;
-  explicit FixedSizeLimiter(uint32_t max_size, uint32_t request_timeout_ms)
-      : max_size_(max_size),
-        request_timeout_ms_(request_timeout_ms)
+  FixedSizeLimiter l(1, 10 * 1000);
+  EXPECT_EQ(l.Request(), 0);
+  std::atomic<bool> released{ false };
+  std::thread waiter(
+      [&]()
+      {
+        EXPECT_EQ(l.Request(), 0);
+        EXPECT_TRUE(released.load());
+        l.Release();
+      });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  released = true;
+  l.Release();
+  waiter.join();
+  EXPECT_EQ(l.InUse(), 0U);
+}
+
+TEST(FixSizeLimiterTest, Concurrent)  // NOLINT
+{
+  FixedSizeLimiter l(3, 10 * 1000);
+  std::atomic<int> inside{ 0 };
+  std::atomic<bool> too_many{ false };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
   {
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 1000; ++j)
+          {
+            ASSERT_EQ(l.Request(), 0);
+            if (inside.fetch_add(1) >= 3)
+            {
+              too_many = true;
+            }
+            std::this_thread::yield();
+            inside.fetch_sub(1);
+            l.Release();
+          }
+        });
   }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_FALSE(too_many.load());
+  EXPECT_EQ(l.InUse(), 0U);
+}
+
+using mcpp::ShardedTokenBucket;
+using mcpp::SlidingWindowLimiter;
+using mcpp::TokenBucket;
 
-  int Request()
+TEST(TokenBucketTest, BurstThenRate)  // NOLINT
+{
+  TokenBucket bucket(100, 10);
+  auto now = TokenBucket::Clock::now();
+  EXPECT_EQ(bucket.Available(now), 10U);
+  for (int i = 0; i < 10; ++i)
   {
-    std::unique_lock<std::mutex> lock_guard(mutex_);
-    while (total_cnt_ >= max_size_)
-    {
-      auto timeout = std::chrono::milliseconds(request_timeout_ms_ * 1000);
-      auto ret = condition_.wait_for(lock_guard, timeout);
-      if (ret == std::cv_status::timeout)
-        return 1;
-    }
-    total_cnt_++;
-    std::cout << "FixedSizeLimiter request a token, total_cnt: " << total_cnt_ << "\n";
-    return 0;
+    EXPECT_TRUE(bucket.TryAcquire(1, now));
   }
+  EXPECT_FALSE(bucket.TryAcquire(1, now));
+  EXPECT_EQ(bucket.Available(now), 0U);
+
+  // 100 tokens per second: one every 10 ms, refilled lazily
+  now += std::chrono::milliseconds(25);
+  EXPECT_EQ(bucket.Available(now), 2U);
+  EXPECT_FALSE(bucket.TryAcquire(3, now));
+  EXPECT_TRUE(bucket.TryAcquire(2, now));
+  EXPECT_FALSE(bucket.TryAcquire(1, now));
+
+  // never more than the burst
+  now += std::chrono::seconds(10);
+  EXPECT_EQ(bucket.Available(now), 10U);
+  EXPECT_FALSE(bucket.TryAcquire(11, now));
+  EXPECT_TRUE(bucket.TryAcquire(10, now));
+}
 
-  void Release()
+TEST(TokenBucketTest, Concurrent)  // NOLINT
+{
+  TokenBucket bucket(1, 1000);
+  auto now = TokenBucket::Clock::now();
+  std::atomic<int> admitted{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 500; ++j)
+          {
+            admitted += bucket.TryAcquire(1, now) ? 1 : 0;
+          }
+        });
+  }
+  for (auto& thread : threads)
   {
-    std::unique_lock<std::mutex> lock_guard(mutex_);
-    total_cnt_--;
-    condition_.notify_one();
-    std::cout << "FixedSizeLimiter release a token, total_cnt: " << total_cnt_ << "\n";
+    thread.join();
   }
+  EXPECT_EQ(admitted.load(), 1000);
+}
 
- private:
-  uint32_t max_size_;
-  uint32_t total_cnt_ = 0;
-  uint32_t request_timeout_ms_ = 0;
-  std::mutex mutex_;
-  std::condition_variable condition_;
-};
+TEST(SlidingWindowLimiterTest, WeightsThePreviousWindow)  // NOLINT
+{
+  SlidingWindowLimiter limiter(10, std::chrono::seconds(1));
+  // at the start of a window
+  auto start = SlidingWindowLimiter::Clock::time_point(std::chrono::seconds(1000));
+  EXPECT_FALSE(limiter.TryAcquire(11, start));
+  EXPECT_TRUE(limiter.TryAcquire(10, start));
+  EXPECT_FALSE(limiter.TryAcquire(1, start + std::chrono::milliseconds(999)));
 
-// NOLINTEND
-TEST(FixSizeLimiterTest, Const)  // NOLINT
+  // half of the previous window is still in the sliding window: 5 of its 10 count
+  auto half = start + std::chrono::milliseconds(1500);
+  EXPECT_TRUE(limiter.TryAcquire(5, half));
+  EXPECT_FALSE(limiter.TryAcquire(1, half));
+
+  // two windows later, nothing counts anymore
+  auto later = start + std::chrono::seconds(3);
+  EXPECT_TRUE(limiter.TryAcquire(10, later));
+  EXPECT_FALSE(limiter.TryAcquire(1, later));
+}
+
+TEST(SlidingWindowLimiterTest, StaleTimeDoesNotResetTheWindow)  // NOLINT
 {
-  auto l = FixedSizeLimiter(10, 1000);
-  l.Request();
-  l.Request();
-  l.Release();
-  l.Release();
-}
\ No newline at end of file
+  SlidingWindowLimiter limiter(10, std::chrono::seconds(1));
+  auto start = SlidingWindowLimiter::Clock::time_point(std::chrono::seconds(1000));
+  EXPECT_TRUE(limiter.TryAcquire(10, start));
+  // a time two windows old maps to the word of the current window: it must not move it back
+  EXPECT_FALSE(limiter.TryAcquire(1, start - std::chrono::seconds(2)));
+  EXPECT_FALSE(limiter.TryAcquire(1, start - std::chrono::seconds(1)));
+  EXPECT_FALSE(limiter.TryAcquire(1, start + std::chrono::milliseconds(500)));
+}
+
+TEST(SlidingWindowLimiterTest, CrossesTheWrapOfTheWindowNumbers)  // NOLINT
+{
+  SlidingWindowLimiter limiter(100, std::chrono::milliseconds(1));
+  // 2^32 windows of 1 ms: the 32-bit window numbers of the words wrap to 0
+  const auto wrap = SlidingWindowLimiter::Clock::time_point(std::chrono::milliseconds(int64_t{ 1 } << 32));
+  EXPECT_TRUE(limiter.TryAcquire(1, wrap - std::chrono::milliseconds(3)));
+  EXPECT_TRUE(limiter.TryAcquire(1, wrap - std::chrono::milliseconds(2)));
+  // the request of the window before still counts in full at the start of this one
+  EXPECT_FALSE(limiter.TryAcquire(100, wrap - std::chrono::milliseconds(1)));
+  EXPECT_TRUE(limiter.TryAcquire(99, wrap - std::chrono::milliseconds(1)));
+
+  // the window before the wrap is still the previous one: half of its 99 count
+  const auto half = wrap + std::chrono::microseconds(500);
+  EXPECT_FALSE(limiter.TryAcquire(51, half));
+  EXPECT_TRUE(limiter.TryAcquire(50, half));
+  EXPECT_FALSE(limiter.TryAcquire(1, half));
+
+  const auto hour = wrap + std::chrono::hours(1);
+  EXPECT_TRUE(limiter.TryAcquire(100, hour));
+  EXPECT_FALSE(limiter.TryAcquire(1, hour));
+  // and a time from before the wrap is stale
+  EXPECT_FALSE(limiter.TryAcquire(1, wrap - std::chrono::milliseconds(1)));
+}
+
+TEST(ShardedTokenBucketTest, TakesAcrossShards)  // NOLINT
+{
+  // 2 tokens per shard: a request for 3 spans several shards
+  ShardedTokenBucket bucket(80, 16, 8);
+  auto now = ShardedTokenBucket::Clock::now();
+  EXPECT_TRUE(bucket.TryAcquire(3, now));
+  EXPECT_EQ(bucket.Available(now), 13U);
+  EXPECT_TRUE(bucket.TryAcquire(13, now));
+  EXPECT_EQ(bucket.Available(now), 0U);
+
+  // a request that the shards cannot serve together takes nothing
+  now += std::chrono::milliseconds(100);
+  EXPECT_EQ(bucket.Available(now), 8U);
+  EXPECT_FALSE(bucket.TryAcquire(9, now));
+  EXPECT_FALSE(bucket.TryAcquire(17, now));
+  EXPECT_EQ(bucket.Available(now), 8U);
+  EXPECT_TRUE(bucket.TryAcquire(8, now));
+}
+
+TEST(ShardedTokenBucketTest, BorrowsFromOtherShards)  // NOLINT
+{
+  ShardedTokenBucket bucket(80, 16, 8);
+  auto now = ShardedTokenBucket::Clock::now();
+  EXPECT_EQ(bucket.Available(now), 16U);
+  // one thread takes the whole burst, from its shard and then from the others
+  for (int i = 0; i < 16; ++i)
+  {
+    EXPECT_TRUE(bucket.TryAcquire(1, now));
+  }
+  EXPECT_FALSE(bucket.TryAcquire(1, now));
+
+  // 80 tokens per second in total
+  now += std::chrono::milliseconds(100);
+  std::atomic<int> admitted{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 100; ++j)
+          {
+            admitted += bucket.TryAcquire(1, now) ? 1 : 0;
+          }
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(admitted.load(), 8);
+}
@@ -1,216 +1,315 @@
-// NOLINTBEGIN
+#include "mcpp/lock_free_pool.h"
+
+#include <gtest/gtest.h>
+
 #include <atomic>
-#include <boost/lockfree/queue.hpp>
-#include <functional>
-#include <iostream>
-#include <mutex>
+#include <chrono>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 
+using namespace mcpp;  // NOLINT
 
-/**
-  reference:
-  https://stackoverflow.com/questions/43540943/using-boost-lockfree-queue-is-slower-than-using-mutexes
-  https://blog.afach.de/?p=825
-*/
-class LockFreePool
+TEST(LockFreePoolTest, CreatesOnDemandAndReuses)  // NOLINT
 {
-  class Object
+  int created = 0;
+  LockFreePool<std::string> pool(2, [&]() { return "obj" + std::to_string(created++); });
   {
-   public:
-    Object(std::string obj, uint32_t obj_idx, LockFreePool *pool_ptr) : obj_(obj), obj_idx_(obj_idx), pool_ptr_(pool_ptr)
-    {
-    }
-    Object() = delete;
-    Object(const Object &) = delete;
-    Object &operator=(const Object &) = delete;
-    Object(Object &&) = delete;
-    Object &operator=(Object &&) = delete;
-
-    ~Object();
-
-    std::string GetRawobj()
-    {
-      return obj_;
-    }
-
-   private:
-    std::string obj_;
-    uint32_t obj_idx_;
-    LockFreePool *pool_ptr_;
-  };
-
- public:
-  LockFreePool(uint32_t size, std::function<std::string()> initializer);
-  LockFreePool() = delete;
-  LockFreePool(const LockFreePool &) = delete;
-  LockFreePool &operator=(const LockFreePool &) = delete;
-  LockFreePool(LockFreePool &&) = delete;
-  LockFreePool &operator=(LockFreePool &&) = delete;
-
-  ~LockFreePool();
-
-  Object Getobj();
-
-  void StartEvictionThread();
-
- protected:
-  void EvictionThread();
-
-  uint32_t size_;
-  std::vector<std::string> objs_pool_;
-
-  // track free obj indexes for creating new obj, and the num is also the real
-  // obj index in `objs_` vector.
-  std::vector<uint32_t> free_obj_indexes_;
-
-  // obj initializer to create new obj object.
-  std::function<std::string()> obj_initializer_;
-
-  // available obj index queue used for geting a available obj in concurrent.
-  boost::lockfree::queue<uint32_t, boost::lockfree::fixed_sized<true>> available_objs_queue_;
+    auto a = pool.Getobj();
+    auto b = pool.Getobj();
+    EXPECT_EQ(*a, "obj0");
+    EXPECT_EQ(*b, "obj1");
+  }
+  {
+    auto a = pool.Getobj();
+    EXPECT_EQ(created, 2);
+  }
+}
 
-  // 使用 atomic 还需要锁吗？
-  // https://cplusplus.com/reference/atomic/atomic/?kw=atomic
-  // The main characteristic of atomic objects is that access to this contained value from different threads cannot cause data races
-  // (i.e., doing that is well-defined behavior, with accesses properly sequenced).
-  // 包裹了value，从不同线程访问该数据不会引起数据竞争。
-  //
-  // Generally, for all other objects, the possibility of causing a data race for accessing the same object concurrently qualifies the operation as undefined behavior.
-  // 比如，多线程访问一个 string，可能访问到了已经释放的地址，导致core
-  // the available obj count of the current pool.
-  std::atomic_uint32_t available_objs_cnt_ = 0;
+TEST(LockFreePoolTest, TryGetAndGetFor)  // NOLINT
+{
+  LockFreePool<std::string> pool(1, []() { return std::string("obj"); });
+  auto a = pool.TryGet();
+  ASSERT_TRUE(a);
+  EXPECT_FALSE(pool.TryGet());
 
-  // track the total obj count of the current pool.
-  std::atomic_uint32_t total_objs_cnt_ = 0;
+  auto start = LockFreePool<std::string>::Clock::now();
+  EXPECT_FALSE(pool.GetFor(std::chrono::milliseconds(20)));
+  EXPECT_GE(LockFreePool<std::string>::Clock::now() - start, std::chrono::milliseconds(20));
 
-  // a mutex to protect `objs_pool_` when creating new obj.
-  std::mutex mutex_;
+  a.reset();
+  EXPECT_TRUE(pool.GetFor(std::chrono::milliseconds(20)));
+}
 
-  std::atomic_bool shutdown = false;
-};
+TEST(LockFreePoolTest, LeaseIsMovable)  // NOLINT
+{
+  LockFreePool<std::vector<int>> pool(1, []() { return std::vector<int>{ 1, 2, 3 }; });
+  auto a = pool.Getobj();
+  const std::vector<int>* obj = a.get();
+  a->push_back(4);
+
+  auto b = std::move(a);
+  EXPECT_FALSE(a);  // NOLINT(bugprone-use-after-move)
+  ASSERT_TRUE(b);
+  EXPECT_EQ(b->size(), 4U);
+  EXPECT_FALSE(pool.TryGet());
+
+  b.reset();
+  EXPECT_FALSE(b);
+  // the same object, in place: no copy
+  auto c = pool.TryGet();
+  ASSERT_TRUE(c);
+  EXPECT_EQ(c.get(), obj);
+  EXPECT_EQ(c->size(), 4U);
+
+  LockFreePool<std::vector<int>>::Lease d;
+  d = std::move(c);
+  EXPECT_EQ(d->size(), 4U);
+}
 
-LockFreePool::Object::~Object()
+TEST(LockFreePoolTest, WakesUpWhenReturned)  // NOLINT
 {
-  if (!obj_.empty())
+  LockFreePool<std::string> pool(1, []() { return std::string("obj"); });
+  std::atomic<bool> returned{ false };
+  std::thread waiter;
   {
-    pool_ptr_->available_objs_queue_.push(obj_idx_);
-    pool_ptr_->available_objs_cnt_++;
-    std::cout << "objPool release obj, obj_idx: " << obj_idx_;
+    auto a = pool.Getobj();
+    waiter = std::thread(
+        [&]()
+        {
+          auto b = pool.Getobj();
+          EXPECT_TRUE(returned.load());
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    returned = true;
   }
+  waiter.join();
+}
+
+TEST(LockFreePoolTest, ThrowingInitializer)  // NOLINT
+{
+  int calls = 0;
+  LockFreePool<int> pool(1,
+                         [&]()
+                         {
+                           if (calls++ < 3)
+                           {
+                             throw std::runtime_error("cannot connect");
+                           }
+                           return 42;
+                         });
+  // a failed creation gives its unit back: every call tries again instead of finding the pool exhausted
+  EXPECT_THROW(pool.Getobj(), std::runtime_error);
+  EXPECT_THROW(pool.TryGet(), std::runtime_error);
+  EXPECT_THROW(pool.GetFor(std::chrono::milliseconds(1)), std::runtime_error);
+  EXPECT_EQ(pool.Size(), 0U);
+
+  auto a = pool.Getobj();
+  EXPECT_EQ(*a, 42);
+  EXPECT_EQ(pool.Size(), 1U);
+  EXPECT_FALSE(pool.TryGet());
 }
 
-LockFreePool::LockFreePool(uint32_t size, std::function<std::string()> initializer) : available_objs_queue_(size)
+TEST(LockFreePoolTest, Contention)  // NOLINT
 {
-  size_ = size;
-  obj_initializer_ = initializer;
-  objs_pool_.reserve(size);
-  objs_pool_.resize(size);
-  for (uint32_t i = 0; i < size; i++)
+  LockFreePool<std::string> pool(3, []() { return std::string("obj"); });
+  std::atomic<int> inside{ 0 };
+  std::atomic<bool> too_many{ false };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 500; ++j)
+          {
+            auto obj = pool.Getobj();
+            if (inside.fetch_add(1) >= 3)
+            {
+              too_many = true;
+            }
+            EXPECT_EQ(*obj, "obj");
+            std::this_thread::yield();
+            inside.fetch_sub(1);
+          }
+        });
+  }
+  for (auto& thread : threads)
   {
-    free_obj_indexes_.push_back(i);
+    thread.join();
   }
-  std::reverse(free_obj_indexes_.begin(), free_obj_indexes_.end());
+  EXPECT_FALSE(too_many.load());
 }
 
-LockFreePool::~LockFreePool()
+TEST(LockFreePoolTest, PrewarmAndMinSize)  // NOLINT
 {
-  shutdown = true;
-  available_objs_queue_.consume_all([](uint32_t &) {});
-  objs_pool_.clear();
+  int created = 0;
+  LockFreePoolOptions options;
+  options.min_size = 2;
+  options.max_size = 8;
+  options.prewarm = 4;
+  options.idle_timeout = std::chrono::milliseconds(0);
+  LockFreePool<int> pool(options, [&]() { return created++; });
+  EXPECT_EQ(created, 4);
+  EXPECT_EQ(pool.Size(), 4U);
+  EXPECT_EQ(pool.Available(), 4U);
+
+  // no demand: evicts down to min_size, in one cycle
+  EXPECT_EQ(pool.Evict(), 2U);
+  EXPECT_EQ(pool.Size(), 2U);
+  EXPECT_EQ(pool.Evict(), 0U);
+  EXPECT_EQ(pool.Size(), 2U);
+  EXPECT_EQ(created, 4);
 }
 
-/**
-  Get an available obj, or create a new one if none exists.
-
-  The returned `obj` will automatically push back obj index to
-  `objPool` when it goes out of scope, so that `available_objs_queue_`
-  could get an available obj.
-
-  Note: `Getobj` method will pop a obj idx from queue in turn that similar
-  with Round‑Robin, so in theory, every obj will be used once in one loop.
-*/
-LockFreePool::Object LockFreePool::Getobj()
+TEST(LockFreePoolTest, EvictsAboveDemandWhenIdle)  // NOLINT
 {
-  uint32_t obj_idx = -1;
-  while (!available_objs_queue_.pop(obj_idx))
+  LockFreePoolOptions options;
+  options.max_size = 8;
+  options.idle_timeout = std::chrono::milliseconds(2000);
+  options.eviction_interval = std::chrono::milliseconds(1000);
+  options.demand_weight = 0.5;
+  LockFreePool<int> pool(options, []() { return 0; });
   {
-    // create new obj when there no available one.
-    if (total_objs_cnt_ < size_)
+    std::vector<LockFreePool<int>::Lease> leases;
+    for (int i = 0; i < 8; ++i)
     {
-      // guarantee `total_objs_cnt_ < size_` is safe in concurrent cases.
-      std::unique_lock<std::mutex> lock_guard(mutex_);
-      if (total_objs_cnt_ < size_)
-      {
-        // pop a available idx to create new obj
-        auto idx = free_obj_indexes_.back();
-        free_obj_indexes_.pop_back();
-
-        // insert a new obj at the idx position of obj vector
-        objs_pool_[idx] = obj_initializer_();
-
-        std::string obj = objs_pool_.at(idx);
-        std::cout << "objPool create new obj, obj_idx: " << total_objs_cnt_.load();
-        total_objs_cnt_++;
-        return Object(obj, idx, this);
-      }
+      leases.push_back(pool.Getobj());
     }
-    // wait a while for next loop to get available obj.
-    std::cout << "objPool wait for an available obj";
-    std::this_thread::sleep_for(std::chrono::microseconds{ 100 * 1000 });
   }
-  available_objs_cnt_--;
-  std::cout << "objPool use an available obj, obj_idx: " << obj_idx;
-  return Object(objs_pool_.at(obj_idx), obj_idx, this);
+  EXPECT_EQ(pool.Size(), 8U);
+  // peak of 8 leases: the demand keeps the objs
+  EXPECT_EQ(pool.Evict(), 0U);
+  EXPECT_DOUBLE_EQ(pool.Demand(), 4.0);
+
+  // the demand drops to 2 then 1, but the objs were returned 1 then 2 cycles ago
+  EXPECT_EQ(pool.Evict(), 0U);
+  EXPECT_DOUBLE_EQ(pool.Demand(), 2.0);
+  EXPECT_EQ(pool.Evict(), 7U);
+  EXPECT_EQ(pool.Size(), 1U);
+
+  // a lease in use is never evicted
+  auto lease = pool.Getobj();
+  for (int i = 0; i < 8; ++i)
+  {
+    pool.Evict();
+  }
+  EXPECT_EQ(pool.Size(), 1U);
 }
 
-void LockFreePool::StartEvictionThread()
+TEST(LockFreePoolTest, IdleTimeoutShorterThanInterval)  // NOLINT
 {
-  std::thread _obj_pool_eviction_thread(
-      [this]()
-      {
-        pthread_setname_np(pthread_self(), "objPoolEvictionThread");
-        EvictionThread();
-      });
-  _obj_pool_eviction_thread.detach();
+  LockFreePoolOptions options;
+  options.max_size = 2;
+  options.idle_timeout = std::chrono::milliseconds(1);
+  // clamped to 1ms
+  options.eviction_interval = std::chrono::milliseconds(0);
+  LockFreePool<int> pool(options, []() { return 0; });
+  {
+    auto lease = pool.Getobj();
+  }
+  // returned just before the cycle: not idle for a whole interval yet
+  EXPECT_EQ(pool.Evict(), 0U);
+  EXPECT_EQ(pool.Evict(), 1U);
+  EXPECT_EQ(pool.Size(), 0U);
 }
 
-void LockFreePool::EvictionThread()
+TEST(LockFreePoolTest, EvictionThread)  // NOLINT
 {
-  while (!shutdown.load())
+  LockFreePoolOptions options;
+  options.max_size = 4;
+  options.prewarm = 4;
+  options.idle_timeout = std::chrono::milliseconds(0);
+  options.eviction_interval = std::chrono::milliseconds(1);
+  LockFreePool<int> pool(options, []() { return 0; });
+  pool.StartEvictionThread();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
   {
-    uint32_t obj_idx = -1;
-    if (available_objs_queue_.pop(obj_idx))
-    {
-      if (available_objs_cnt_ <= 1)
-      {
-        std::cout << "objPool pop a last one obj, obj_idx: " << obj_idx << ", skip eviction";
-        available_objs_queue_.push(obj_idx);
-        goto wait;
-      }
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 2000; ++j)
+          {
+            auto lease = pool.Getobj();
+            EXPECT_EQ(*lease, 0);
+          }
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  while (pool.Size() > 0)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
 
-      // evict this available obj and close it
+TEST(LockFreePoolTest, MagazinesDoNotHideObjs)  // NOLINT
+{
+  LockFreePool<int> pool(2, []() { return 0; });
+  {
+    auto a = pool.Getobj();
+    auto b = pool.Getobj();
+  }
+  // both objs are in the magazine of this thread: the other threads take them from there
+  std::thread(
+      [&]()
       {
-        std::unique_lock<std::mutex> lock_guard(mutex_);
-        auto to_be_removed_obj = objs_pool_.at(obj_idx);
-        // if obj is unavailable, skip eviction in this loop
-        if (to_be_removed_obj.empty())
-          goto wait;
-
-        // clear the obj
-        objs_pool_[obj_idx] = nullptr;
-
-        total_objs_cnt_--;
-        available_objs_cnt_--;
-        free_obj_indexes_.push_back(obj_idx);
-        std::cout << "objPool evict a obj, obj_idx: " << obj_idx
-                  << ", available obj cnt: " << available_objs_cnt_.load();
-      }
-    }
+        auto a = pool.TryGet();
+        ASSERT_TRUE(a);
+        auto b = pool.GetFor(std::chrono::milliseconds(1));
+        ASSERT_TRUE(b);
+        EXPECT_FALSE(pool.TryGet());
+      })
+      .join();
+  std::thread([&]() { auto a = pool.Getobj(); }).join();
+
+  // a waiter is woken up by an obj returned to a magazine
+  auto a = pool.Getobj();
+  auto b = pool.Getobj();
+  std::thread waiter([&]() { auto c = pool.Getobj(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  a.reset();
+  waiter.join();
+}
 
-  wait:
-    // wait 30 seconds for next loop to get available obj to check
-    std::this_thread::sleep_for(std::chrono::microseconds{ 30 * 1000 * 1000 });
+TEST(LockFreePoolTest, Metrics)  // NOLINT
+{
+  LockFreePoolOptions options;
+  options.max_size = 2;
+  options.idle_timeout = std::chrono::milliseconds(0);
+  options.latency_sample_period = 1;
+  LockFreePool<int> pool(options, []() { return 0; });
+  LockFreePoolMetrics before = pool.Metrics();
+  {
+    auto a = pool.Getobj();
+    auto b = pool.Getobj();
+    EXPECT_FALSE(pool.GetFor(std::chrono::milliseconds(1)));
+    LockFreePoolMetrics metrics = pool.Metrics();
+    EXPECT_EQ(metrics.size, 2U);
+    EXPECT_EQ(metrics.leased, 2U);
+    EXPECT_DOUBLE_EQ(metrics.Utilization(), 1.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
   }
+  auto c = pool.Getobj();
+  c.reset();
+  pool.Evict();
+
+  LockFreePoolMetrics metrics = pool.Metrics();
+  EXPECT_EQ(metrics.checkouts, 3U);
+  EXPECT_EQ(metrics.magazine_hits, 1U);
+  EXPECT_EQ(metrics.waits, 1U);
+  EXPECT_EQ(metrics.timeouts, 1U);
+  EXPECT_EQ(metrics.creations, 2U);
+  EXPECT_EQ(metrics.evictions, 2U);
+  EXPECT_EQ(metrics.size, 0U);
+  EXPECT_GT(metrics.CreationRate(before), 0);
+  EXPECT_GT(metrics.EvictionRate(before), 0);
+  EXPECT_EQ(metrics.wait_ns.count, 3U);
+  EXPECT_EQ(metrics.lease_ns.count, 3U);
+  // a and b were held for 5 ms at least
+  EXPECT_GE(metrics.lease_ns.Percentile(1), 5000000U);
 }
-// NOLINTEND
\ No newline at end of file
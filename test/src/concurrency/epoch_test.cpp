@@ -0,0 +1,157 @@
+#include "mcpp/epoch.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+namespace
+{
+  std::atomic<int64_t> live_payloads{ 0 };
+
+  // a reader that sees a freed payload sees check != ~value (ASan also catches the read itself)
+  struct Payload
+  {
+    explicit Payload(uint64_t v) : value(v), check(~v)
+    {
+      live_payloads.fetch_add(1, std::memory_order_relaxed);
+    }
+    Payload(const Payload&) = delete;
+    Payload& operator=(const Payload&) = delete;
+    ~Payload()
+    {
+      check = value;
+      live_payloads.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    uint64_t value;
+    uint64_t check;
+  };
+
+  void reclaim_all()
+  {
+    EpochDomain::global().reclaim();
+    EpochDomain::global().reclaim();
+  }
+}  // namespace
+
+TEST(EpochTest, CriticalSectionDelaysReclamation)  // NOLINT
+{
+  std::atomic<Payload*> shared{ new Payload(1) };
+  std::atomic<bool> entered{ false };
+  std::atomic<bool> done{ false };
+  std::thread reader(
+      [&]()
+      {
+        EpochGuard guard;
+        Payload* payload = shared.load(std::memory_order_acquire);
+        entered = true;
+        while (!done)
+        {
+          std::this_thread::yield();
+        }
+        EXPECT_EQ(payload->check, ~payload->value);
+      });
+  while (!entered)
+  {
+    std::this_thread::yield();
+  }
+
+  EpochDomain::global().retire(shared.exchange(nullptr));
+  const uint64_t epoch = EpochDomain::global().epoch();
+  reclaim_all();
+  reclaim_all();
+  // the reader holds the epoch back, by one at most
+  EXPECT_LE(EpochDomain::global().epoch(), epoch + 1);
+  EXPECT_EQ(live_payloads.load(), 1);
+
+  done = true;
+  reader.join();
+  reclaim_all();
+  EXPECT_EQ(live_payloads.load(), 0);
+}
+
+TEST(EpochTest, Nesting)  // NOLINT
+{
+  auto* payload = new Payload(2);
+  {
+    EpochGuard outer;
+    {
+      EpochGuard inner;
+    }
+    // still in the outer critical section
+    EpochDomain::global().retire(payload);
+    reclaim_all();
+    EXPECT_EQ(live_payloads.load(), 1);
+  }
+  reclaim_all();
+  EXPECT_EQ(live_payloads.load(), 0);
+}
+
+TEST(EpochTest, ReadMostly)  // NOLINT
+{
+  // readers scan the slots in critical sections, writers replace the payloads and retire the old ones
+  constexpr std::size_t kSlots = 16;
+  constexpr int kReaders = 3;
+  constexpr int kWriters = 2;
+  constexpr uint64_t kWrites = 20000;
+  std::array<std::atomic<Payload*>, kSlots> slots{};
+  for (auto& slot : slots)
+  {
+    slot.store(new Payload(0));
+  }
+
+  std::atomic<int> writers_done{ 0 };
+  std::atomic<bool> torn{ false };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kReaders; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          while (writers_done.load() < kWriters)
+          {
+            EpochGuard guard;
+            for (auto& slot : slots)
+            {
+              Payload* payload = slot.load(std::memory_order_acquire);
+              if (payload->check != ~payload->value)
+              {
+                torn = true;
+              }
+            }
+          }
+        });
+  }
+  for (int i = 0; i < kWriters; ++i)
+  {
+    threads.emplace_back(
+        [&, i]()
+        {
+          for (uint64_t j = 0; j < kWrites; ++j)
+          {
+            auto* fresh = new Payload(j);
+            Payload* old = slots[(j * kWriters + static_cast<uint64_t>(i)) % kSlots].exchange(fresh, std::memory_order_acq_rel);
+            EpochDomain::global().retire(old);
+          }
+          writers_done.fetch_add(1);
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_FALSE(torn.load());
+
+  for (auto& slot : slots)
+  {
+    EpochDomain::global().retire(slot.exchange(nullptr));
+  }
+  reclaim_all();
+  EXPECT_EQ(live_payloads.load(), 0);
+}
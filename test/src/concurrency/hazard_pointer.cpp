@@ -18,3 +18,274 @@
 // Periodically, a thread (or a dedicated reclamation thread) scans the retire list. For each object on the retire list, it
 // checks if its address is present in any thread's hazard pointer. If an object's address is not found in any active hazard
 // pointer, it means no thread is currently accessing it, and it can be safely deallocated.
+
+#include "mcpp/hazard_pointer.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+namespace
+{
+  // counts the nodes alive, to check that every retired node is freed in the end
+  std::atomic<int64_t> live_nodes{ 0 };
+
+  struct Node
+  {
+    explicit Node(int64_t v) : value(v)
+    {
+      live_nodes.fetch_add(1, std::memory_order_relaxed);
+    }
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+    ~Node()
+    {
+      live_nodes.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    int64_t value;
+    std::atomic<Node*> next{ nullptr };
+  };
+
+  // Treiber stack: pop protects the top before it reads its next, so that the top is not freed (and its memory reused
+  // for a new node pushed back on top, ABA) between the read and the CAS
+  class TreiberStack
+  {
+   public:
+    TreiberStack() = default;
+    TreiberStack(const TreiberStack&) = delete;
+    TreiberStack& operator=(const TreiberStack&) = delete;
+
+    ~TreiberStack()
+    {
+      int64_t value = 0;
+      while (pop(value))
+      {
+      }
+    }
+
+    void push(int64_t value)
+    {
+      auto* node = new Node(value);
+      Node* top = head_.load(std::memory_order_relaxed);
+      do
+      {
+        node->next.store(top, std::memory_order_relaxed);
+      } while (!head_.compare_exchange_weak(top, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    bool pop(int64_t& value)
+    {
+      HazardPointer hp;
+      for (;;)
+      {
+        Node* top = hp.protect(head_);
+        if (top == nullptr)
+        {
+          return false;
+        }
+        if (head_.compare_exchange_strong(
+                top, top->next.load(std::memory_order_relaxed), std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          value = top->value;
+          hp.reset_protection();
+          retire(top);
+          return true;
+        }
+      }
+    }
+
+   private:
+    std::atomic<Node*> head_{ nullptr };
+  };
+
+  // Michael and Scott queue, with a dummy node at the head: dequeue protects the head and its next, enqueue the tail
+  class MSQueue
+  {
+   public:
+    MSQueue() : head_(new Node(0)), tail_(head_.load())
+    {
+    }
+    MSQueue(const MSQueue&) = delete;
+    MSQueue& operator=(const MSQueue&) = delete;
+
+    ~MSQueue()
+    {
+      int64_t value = 0;
+      while (pop(value))
+      {
+      }
+      delete head_.load();
+    }
+
+    void push(int64_t value)
+    {
+      auto* node = new Node(value);
+      HazardPointer hp;
+      for (;;)
+      {
+        Node* tail = hp.protect(tail_);
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail != tail_.load(std::memory_order_acquire))
+        {
+          continue;
+        }
+        if (next != nullptr)
+        {
+          // the tail lags behind, help to move it
+          tail_.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
+          continue;
+        }
+        if (tail->next.compare_exchange_strong(next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+          tail_.compare_exchange_strong(tail, node, std::memory_order_release, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+
+    bool pop(int64_t& value)
+    {
+      HazardPointer hp_head;
+      HazardPointer hp_next;
+      for (;;)
+      {
+        Node* head = hp_head.protect(head_);
+        Node* tail = tail_.load(std::memory_order_acquire);
+        Node* next = head->next.load(std::memory_order_acquire);
+        if (!hp_next.try_protect(next, head->next) || head != head_.load(std::memory_order_acquire))
+        {
+          continue;
+        }
+        if (next == nullptr)
+        {
+          return false;
+        }
+        if (head == tail)
+        {
+          tail_.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
+          continue;
+        }
+        // read the value before the CAS: once next is the new dummy, another pop may retire it
+        int64_t result = next->value;
+        if (head_.compare_exchange_strong(head, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+          value = result;
+          hp_head.reset_protection();
+          retire(head);
+          return true;
+        }
+      }
+    }
+
+   private:
+    std::atomic<Node*> head_;
+    std::atomic<Node*> tail_;
+  };
+
+  // every thread pushes kOps distinct values and pops as many, the values popped are exactly the values pushed
+  template<typename Container>
+  void stress()
+  {
+    constexpr int kThreads = 4;
+    constexpr int64_t kOps = 20000;
+    std::atomic<int64_t> pushed_sum{ 0 };
+    std::atomic<int64_t> popped_sum{ 0 };
+    std::atomic<int64_t> popped{ 0 };
+    {
+      Container container;
+      std::vector<std::thread> threads;
+      for (int t = 0; t < kThreads; ++t)
+      {
+        threads.emplace_back(
+            [&, t]()
+            {
+              int64_t sum = 0;
+              int64_t count = 0;
+              for (int64_t i = 0; i < kOps; ++i)
+              {
+                int64_t v = t * kOps + i;
+                container.push(v);
+                pushed_sum.fetch_add(v, std::memory_order_relaxed);
+                int64_t value = 0;
+                if (container.pop(value))
+                {
+                  sum += value;
+                  ++count;
+                }
+              }
+              popped_sum.fetch_add(sum);
+              popped.fetch_add(count);
+            });
+      }
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+      // a thread pops after its own push, so the container ends up empty
+      int64_t value = 0;
+      EXPECT_FALSE(container.pop(value));
+    }
+    EXPECT_EQ(popped.load(), kThreads * kOps);
+    EXPECT_EQ(popped_sum.load(), pushed_sum.load());
+
+    HazardPointerDomain::global().reclaim();
+    EXPECT_EQ(live_nodes.load(), 0);
+  }
+}  // namespace
+
+TEST(HazardPointerTest, Protect)  // NOLINT
+{
+  std::atomic<Node*> src{ new Node(1) };
+  HazardPointer hp;
+  Node* node = hp.protect(src);
+  src.store(nullptr);
+  retire(node);
+
+  // protected: it survives the scans
+  HazardPointerDomain::global().reclaim();
+  EXPECT_EQ(live_nodes.load(), 1);
+  EXPECT_EQ(node->value, 1);
+
+  hp.reset_protection();
+  HazardPointerDomain::global().reclaim();
+  EXPECT_EQ(live_nodes.load(), 0);
+
+  // try_protect fails and reloads when the source changed
+  Node other(2);
+  Node* stale = &other;
+  EXPECT_FALSE(hp.try_protect(stale, src));
+  EXPECT_EQ(stale, nullptr);
+}
+
+TEST(HazardPointerTest, SlotsAreReused)  // NOLINT
+{
+  {
+    HazardPointer a;
+    HazardPointer b;
+  }
+  const std::size_t slots = HazardPointerDomain::global().slot_count();
+  for (int i = 0; i < 100; ++i)
+  {
+    HazardPointer a;
+    HazardPointer b;
+  }
+  std::thread([]() { HazardPointer hp; }).join();
+  std::thread([]() { HazardPointer hp; }).join();
+  EXPECT_LE(HazardPointerDomain::global().slot_count(), slots + 1);
+}
+
+TEST(HazardPointerTest, TreiberStack)  // NOLINT
+{
+  stress<TreiberStack>();
+}
+
+TEST(HazardPointerTest, MichaelScottQueue)  // NOLINT
+{
+  stress<MSQueue>();
+}
@@ -0,0 +1,236 @@
+#include "mcpp/parking_lot.h"
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+namespace
+{
+  // wait until `pred` holds, the threads under test park and wake up asynchronously
+  template<typename Pred>
+  void spin_until(Pred pred)
+  {
+    while (!pred())
+    {
+      std::this_thread::yield();
+    }
+  }
+}  // namespace
+
+TEST(ParkingLotTest, NothingParked)  // NOLINT
+{
+  int word = 0;
+  EXPECT_FALSE(ParkingLot::parkConditionally(&word, []() { return false; }, []() {}));
+
+  bool called = false;
+  ParkingLot::unparkOne(
+      &word,
+      [&](bool did_unpark, bool queue_empty)
+      {
+        called = true;
+        EXPECT_FALSE(did_unpark);
+        EXPECT_TRUE(queue_empty);
+      });
+  EXPECT_TRUE(called);
+}
+
+TEST(ParkingLotTest, Fifo)  // NOLINT
+{
+  int word = 0;
+  std::atomic<int> parked{ 0 };
+  std::atomic<int> woken{ 0 };
+  std::array<int, 3> order{};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i)
+  {
+    // park the threads one after another, before_sleep runs once the thread is in the queue
+    threads.emplace_back(
+        [&, i]()
+        {
+          EXPECT_TRUE(ParkingLot::parkConditionally(&word, []() { return true; }, [&]() { parked.fetch_add(1); }));
+          order[static_cast<std::size_t>(woken.fetch_add(1))] = i;
+        });
+    spin_until([&]() { return parked.load() == i + 1; });
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    ParkingLot::unparkOne(
+        &word,
+        [&](bool did_unpark, bool queue_empty)
+        {
+          EXPECT_TRUE(did_unpark);
+          EXPECT_EQ(queue_empty, i == 2);
+        });
+    spin_until([&]() { return woken.load() == i + 1; });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(order, (std::array<int, 3>{ 0, 1, 2 }));
+}
+
+TEST(ParkingLotTest, Timeout)  // NOLINT
+{
+  int word = 0;
+  auto timeout = ParkingLot::Clock::now() + std::chrono::milliseconds(20);
+  EXPECT_FALSE(ParkingLot::parkConditionally(&word, []() { return true; }, []() {}, timeout));
+  EXPECT_GE(ParkingLot::Clock::now(), timeout);
+
+  // the thread left the queue
+  ParkingLot::unparkOne(&word, [](bool did_unpark, bool /*queue_empty*/) { EXPECT_FALSE(did_unpark); });
+}
+
+TEST(ParkingLotTest, ManyAddresses)  // NOLINT
+{
+  // more threads than the initial table fits: it grows while threads are parked, and keeps them reachable
+  constexpr int kThreads = 64;
+  std::array<int, kThreads> words{};
+  std::atomic<int> parked{ 0 };
+  std::atomic<int> woken{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i)
+  {
+    threads.emplace_back(
+        [&, i]()
+        {
+          EXPECT_TRUE(ParkingLot::parkConditionally(
+              &words[static_cast<std::size_t>(i)], []() { return true; }, [&]() { parked.fetch_add(1); }));
+          woken.fetch_add(1);
+        });
+  }
+  spin_until([&]() { return parked.load() == kThreads; });
+  EXPECT_GE(ParkingLot::bucketCount(), 3U * kThreads);
+
+  // unparking one address does not wake the others
+  ParkingLot::unparkOne(&words[0], [](bool did_unpark, bool queue_empty) { EXPECT_TRUE(did_unpark && queue_empty); });
+  spin_until([&]() { return woken.load() == 1; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(woken.load(), 1);
+
+  for (int i = 1; i < kThreads; ++i)
+  {
+    ParkingLot::unparkOne(&words[static_cast<std::size_t>(i)], [](bool did_unpark, bool /*queue_empty*/) { EXPECT_TRUE(did_unpark); });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(woken.load(), kThreads);
+}
+
+TEST(ParkingLotTest, UnparkAll)  // NOLINT
+{
+  int word = 0;
+  int other = 0;
+  std::atomic<int> parked{ 0 };
+  std::atomic<int> woken{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(
+        [&, i]()
+        {
+          int* address = i == 3 ? &other : &word;
+          EXPECT_TRUE(ParkingLot::parkConditionally(address, []() { return true; }, [&]() { parked.fetch_add(1); }));
+          woken.fetch_add(1);
+        });
+  }
+  spin_until([&]() { return parked.load() == 4; });
+
+  EXPECT_EQ(ParkingLot::unparkAll(&word), 3U);
+  spin_until([&]() { return woken.load() == 3; });
+  EXPECT_EQ(ParkingLot::unparkAll(&word), 0U);
+  EXPECT_EQ(ParkingLot::unparkAll(&other), 1U);
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+TEST(ParkingLotTest, Requeue)  // NOLINT
+{
+  int from = 0;
+  int to = 0;
+  std::atomic<int> parked{ 0 };
+  std::atomic<int> woken{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          EXPECT_TRUE(ParkingLot::parkConditionally(&from, []() { return true; }, [&]() { parked.fetch_add(1); }));
+          woken.fetch_add(1);
+        });
+  }
+  spin_until([&]() { return parked.load() == 3; });
+
+  EXPECT_EQ(ParkingLot::unparkAndRequeue(&from, &to, 1), 1U);
+  spin_until([&]() { return woken.load() == 1; });
+  EXPECT_EQ(ParkingLot::unparkAll(&from), 0U);
+  EXPECT_EQ(ParkingLot::unparkAll(&to), 2U);
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // a requeued thread that times out leaves the queue of its new address
+  parked = 0;
+  std::thread waiter(
+      [&]()
+      {
+        auto timeout = ParkingLot::Clock::now() + std::chrono::milliseconds(50);
+        EXPECT_FALSE(ParkingLot::parkConditionally(&from, []() { return true; }, [&]() { parked.fetch_add(1); }, timeout));
+      });
+  spin_until([&]() { return parked.load() == 1; });
+  EXPECT_EQ(ParkingLot::unparkAndRequeue(&from, &to, 0), 0U);
+  waiter.join();
+  EXPECT_EQ(ParkingLot::unparkAll(&to), 0U);
+}
+
+TEST(ParkingLotTest, Signals)  // NOLINT
+{
+  // a signal interrupts the wait of a parked thread (EINTR from the futex), it goes back to sleep until unparked
+  struct sigaction action
+  {
+  };
+  action.sa_handler = [](int) {};
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = 0;  // no SA_RESTART
+  struct sigaction previous
+  {
+  };
+  ASSERT_EQ(sigaction(SIGUSR1, &action, &previous), 0);
+
+  int word = 0;
+  std::atomic<int> parked{ 0 };
+  std::atomic<bool> woken{ false };
+  std::thread thread(
+      [&]()
+      {
+        EXPECT_TRUE(ParkingLot::parkConditionally(&word, []() { return true; }, [&]() { parked.fetch_add(1); }));
+        woken = true;
+      });
+  spin_until([&]() { return parked.load() == 1; });
+  for (int i = 0; i < 10; ++i)
+  {
+    pthread_kill(thread.native_handle(), SIGUSR1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_FALSE(woken.load());
+
+  ParkingLot::unparkOne(&word, [](bool did_unpark, bool /*queue_empty*/) { EXPECT_TRUE(did_unpark); });
+  thread.join();
+  EXPECT_TRUE(woken.load());
+  sigaction(SIGUSR1, &previous, nullptr);
+}
@@ -0,0 +1,202 @@
+#include "mcpp/parking_primitives.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+static_assert(sizeof(Condition) == 1, "");
+static_assert(sizeof(Semaphore) == 4, "");
+static_assert(sizeof(Event) == 1, "");
+static_assert(sizeof(RWLock) == 4, "");
+
+TEST(ParkingPrimitivesTest, Condition)  // NOLINT
+{
+  std::mutex mutex;
+  Condition condition;
+  int produced = 0;
+  int consumed = 0;
+  std::thread consumer(
+      [&]()
+      {
+        for (int i = 0; i < 1000; ++i)
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(lock, [&]() { return produced > consumed; });
+          ++consumed;
+          condition.notify_one();
+        }
+      });
+  for (int i = 0; i < 1000; ++i)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return produced == consumed; });
+    ++produced;
+    condition.notify_one();
+  }
+  consumer.join();
+  EXPECT_EQ(consumed, 1000);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  auto timeout = Condition::Clock::now() + std::chrono::milliseconds(10);
+  EXPECT_FALSE(condition.wait_until(lock, timeout, []() { return false; }));
+  EXPECT_TRUE(lock.owns_lock());
+}
+
+TEST(ParkingPrimitivesTest, ConditionNotifyAll)  // NOLINT
+{
+  std::mutex mutex;
+  Condition condition;
+  bool go = false;
+  int waiting = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          ++waiting;
+          condition.wait(lock, [&]() { return go; });
+        });
+  }
+  for (;;)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (waiting == 8)
+    {
+      go = true;
+      break;
+    }
+  }
+  condition.notify_all();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+TEST(ParkingPrimitivesTest, Semaphore)  // NOLINT
+{
+  Semaphore semaphore(2);
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_FALSE(semaphore.try_acquire());
+  EXPECT_FALSE(semaphore.try_acquire_until(Semaphore::Clock::now() + std::chrono::milliseconds(10)));
+  semaphore.release(2);
+  EXPECT_EQ(semaphore.count(), 2U);
+
+  // at most 2 threads at a time between acquire and release
+  std::atomic<int> inside{ 0 };
+  std::atomic<int> max_inside{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 200; ++j)
+          {
+            semaphore.acquire();
+            int now = inside.fetch_add(1) + 1;
+            int max = max_inside.load();
+            while (now > max && !max_inside.compare_exchange_weak(max, now))
+            {
+            }
+            std::this_thread::yield();
+            inside.fetch_sub(1);
+            semaphore.release();
+          }
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_LE(max_inside.load(), 2);
+  EXPECT_EQ(semaphore.count(), 2U);
+}
+
+TEST(ParkingPrimitivesTest, Event)  // NOLINT
+{
+  Event event;
+  EXPECT_FALSE(event.wait_until(Event::Clock::now() + std::chrono::milliseconds(10)));
+
+  std::atomic<int> woken{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          event.wait();
+          woken.fetch_add(1);
+        });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(woken.load(), 0);
+  event.set();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(woken.load(), 4);
+  EXPECT_TRUE(event.is_set());
+  event.wait();
+}
+
+TEST(ParkingPrimitivesTest, RWLock)  // NOLINT
+{
+  RWLock lock;
+  lock.lock_shared();
+  EXPECT_TRUE(lock.try_lock_shared());
+  EXPECT_FALSE(lock.try_lock());
+  lock.unlock_shared();
+  lock.unlock_shared();
+  EXPECT_TRUE(lock.try_lock());
+  EXPECT_FALSE(lock.try_lock_shared());
+  lock.unlock();
+
+  // writers keep the two halves of the pair equal, readers never see them differ
+  int a = 0;
+  int b = 0;
+  std::atomic<bool> torn{ false };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back(
+        [&, i]()
+        {
+          for (int j = 0; j < 2000; ++j)
+          {
+            if (i % 4 == 0)
+            {
+              std::lock_guard<RWLock> guard(lock);
+              ++a;
+              std::this_thread::yield();
+              ++b;
+            }
+            else
+            {
+              std::shared_lock<RWLock> guard(lock);
+              if (a != b)
+              {
+                torn = true;
+              }
+            }
+          }
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_FALSE(torn.load());
+  EXPECT_EQ(a, 4000);
+}
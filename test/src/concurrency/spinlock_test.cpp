@@ -7,3 +7,118 @@
 // tas_lock: test-and-set lock
 // ttas_lock: test and test-and-set lock: optimized for the uncontended case. First it tries to acquire the lock, if that
 // fails it spins waiting for the lock to be released.
+
+#include "mcpp/spinlock.h"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+namespace
+{
+  template<typename Lock, typename = void>
+  struct HasTryLock : std::false_type
+  {
+  };
+  template<typename Lock>
+  struct HasTryLock<Lock, std::void_t<decltype(std::declval<Lock&>().try_lock())>> : std::true_type
+  {
+  };
+
+  // the counter is not atomic: the lock is the only thing that keeps the increments from being lost
+  template<typename Lock>
+  void check_mutual_exclusion()
+  {
+    Lock lock;
+    if constexpr (HasTryLock<Lock>::value)
+    {
+      EXPECT_TRUE(lock.try_lock());
+      EXPECT_FALSE(lock.try_lock());
+      lock.unlock();
+    }
+
+    constexpr int kThreads = 4;
+    constexpr int kIncrements = 5000;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i)
+    {
+      threads.emplace_back(
+          [&]()
+          {
+            for (int j = 0; j < kIncrements; ++j)
+            {
+              std::lock_guard<Lock> guard(lock);
+              ++counter;
+            }
+          });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    EXPECT_EQ(counter, kThreads * kIncrements);
+  }
+}  // namespace
+
+TEST(SpinlockTest, TAS)  // NOLINT
+{
+  check_mutual_exclusion<TASLock>();
+}
+
+TEST(SpinlockTest, TTAS)  // NOLINT
+{
+  check_mutual_exclusion<TTASLock>();
+}
+
+TEST(SpinlockTest, Ticket)  // NOLINT
+{
+  check_mutual_exclusion<TicketLock>();
+}
+
+TEST(SpinlockTest, MCS)  // NOLINT
+{
+  check_mutual_exclusion<MCSLock>();
+}
+
+TEST(SpinlockTest, CLH)  // NOLINT
+{
+  // a try_lock could have to wait behind another owner once queued
+  static_assert(!HasTryLock<CLHLock>::value);
+  check_mutual_exclusion<CLHLock>();
+}
+
+TEST(SpinlockTest, Nested)  // NOLINT
+{
+  // a thread holds several queue locks at once, and releases them in any order
+  MCSLock a;
+  MCSLock b;
+  CLHLock c;
+  CLHLock d;
+  a.lock();
+  b.lock();
+  c.lock();
+  d.lock();
+  a.unlock();
+  c.unlock();
+  EXPECT_TRUE(a.try_lock());
+  c.lock();
+  EXPECT_FALSE(b.try_lock());
+  b.unlock();
+  d.unlock();
+  a.unlock();
+  c.unlock();
+}
+
+TEST(SpinlockTest, Padding)  // NOLINT
+{
+  EXPECT_EQ(alignof(TTASLock), kCacheLineSize);
+  EXPECT_EQ(sizeof(TTASLock), kCacheLineSize);
+  EXPECT_EQ(sizeof(TicketLock), 2 * kCacheLineSize);
+}
@@ -0,0 +1,95 @@
+#include "mcpp/flat_hash_map.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace mcpp;  // NOLINT
+
+TEST(FlatHashMapTest, Test)  // NOLINT
+{
+  FlatHashMap<int, std::string> map{ { 1, "one" }, { 2, "two" } };
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(1), "one");
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_FALSE(map.contains(3));
+  EXPECT_THROW(map.at(3), std::out_of_range);  // NOLINT
+
+  map[3] = "three";
+  EXPECT_FALSE(map.try_emplace(3, "drei").second);
+  EXPECT_EQ(map[3], "three");
+  EXPECT_FALSE(map.insert_or_assign(3, "drei").second);
+  EXPECT_EQ(map[3], "drei");
+
+  EXPECT_EQ(map.erase(1), 1);
+  EXPECT_EQ(map.erase(1), 0);
+  map.erase(map.find(2));
+  EXPECT_EQ(map.size(), 1);
+
+  // copy and move
+  auto copy = map;
+  EXPECT_EQ(copy.at(3), "drei");
+  auto moved = std::move(map);
+  EXPECT_EQ(moved.at(3), "drei");
+  EXPECT_TRUE(map.empty());  // NOLINT(bugprone-use-after-move)
+
+  int n = 0;
+  for (const auto& [key, value] : copy)
+  {
+    EXPECT_EQ(key, 3);
+    EXPECT_EQ(value, "drei");
+    ++n;
+  }
+  EXPECT_EQ(n, 1);
+}
+
+// random inserts and erases against std::unordered_map, with a hash that puts every key in a few clusters to exercise the
+// backward shift deletion and the wrap around the end of the table
+struct ClusteringHash
+{
+  std::size_t operator()(std::uint64_t key) const
+  {
+    return key % 4;
+  }
+};
+
+TEST(FlatHashMapTest, AgainstUnorderedMap)  // NOLINT
+{
+  std::mt19937_64 engine(42);
+  std::uniform_int_distribution<std::uint64_t> dist(0, 2000);
+  FlatHashMap<std::uint64_t, std::uint64_t> map;
+  FlatHashMap<std::uint64_t, std::uint64_t, ClusteringHash> clustered;
+  std::unordered_map<std::uint64_t, std::uint64_t> expected;
+  for (int i = 0; i < 20000; ++i)
+  {
+    std::uint64_t key = dist(engine);
+    if (engine() % 3 == 0)
+    {
+      EXPECT_EQ(map.erase(key), expected.erase(key));
+      clustered.erase(key);
+    }
+    else
+    {
+      map[key] = key * 2;
+      clustered[key] = key * 2;
+      expected[key] = key * 2;
+    }
+  }
+  ASSERT_EQ(map.size(), expected.size());
+  ASSERT_EQ(clustered.size(), expected.size());
+  for (const auto& [key, value] : expected)
+  {
+    EXPECT_EQ(map.at(key), value);
+    EXPECT_EQ(clustered.at(key), value);
+  }
+  for (const auto& [key, value] : map)
+  {
+    EXPECT_EQ(expected.at(key), value);
+  }
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
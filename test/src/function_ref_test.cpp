@@ -0,0 +1,41 @@
+#include "mcpp/function_ref.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace mcpp;  // NOLINT
+
+namespace
+{
+  int apply(FunctionRef<int(int)> f, int x)
+  {
+    return f(x);
+  }
+}  // namespace
+
+TEST(FunctionRefTest, Call)  // NOLINT
+{
+  int offset = 10;
+  EXPECT_EQ(apply([offset](int x) { return x + offset; }, 1), 11);
+
+  // the result converts to the return type of the signature
+  FunctionRef<std::string()> f = []() { return "abc"; };
+  EXPECT_EQ(f(), "abc");
+}
+
+TEST(FunctionRefTest, RefersToTheCallable)  // NOLINT
+{
+  // no copy of the callable: its state changes are visible, and it sees changes to its captures
+  int calls = 0;
+  auto counter = [&calls]() { ++calls; };
+  FunctionRef<void()> f = counter;
+  f();
+  f();
+  EXPECT_EQ(calls, 2);
+
+  const auto twice = [](int x) { return 2 * x; };
+  FunctionRef<int(int)> g = twice;
+  FunctionRef<int(int)> h = g;  // copies the reference, not the callable
+  EXPECT_EQ(h(21), 42);
+}
@@ -0,0 +1,94 @@
+#include "mcpp/metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+TEST(MetricsTest, ShardedCounter)  // NOLINT
+{
+  ShardedCounter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i)
+  {
+    threads.emplace_back(
+        [&]()
+        {
+          for (int j = 0; j < 1000; ++j)
+          {
+            counter.Add();
+          }
+          counter.Add(10);
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(counter.Sum(), 16U * 1010);
+}
+
+TEST(MetricsTest, HistogramBuckets)  // NOLINT
+{
+  // exact below kSubBuckets, then kSubBuckets buckets per power of two
+  for (uint64_t value = 0; value < LatencyHistogram::kSubBuckets; ++value)
+  {
+    EXPECT_EQ(LatencyHistogram::BucketIndex(value), value);
+  }
+  EXPECT_EQ(LatencyHistogram::BucketIndex(8), 8U);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(15), 15U);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(16), 16U);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(17), 16U);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(18), 17U);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+
+  // every value falls in a bucket whose upper bound is within 1 / kSubBuckets above it
+  uint32_t last = 0;
+  for (uint64_t value = 1; value < (uint64_t{ 1 } << 40); value += value / 7 + 1)
+  {
+    const uint32_t index = LatencyHistogram::BucketIndex(value);
+    EXPECT_GE(index, last);
+    last = index;
+    const uint64_t upper = LatencyHistogram::BucketUpperBound(index);
+    EXPECT_GE(upper, value);
+    EXPECT_LE(static_cast<double>(upper), static_cast<double>(value) * 1.125);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(upper), index);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(upper + 1), index + 1);
+  }
+}
+
+TEST(MetricsTest, HistogramPercentiles)  // NOLINT
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Snapshot().Percentile(0.5), 0U);
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(
+        [&, i]()
+        {
+          for (uint64_t value = 1 + i; value <= 1000; value += 4)
+          {
+            histogram.Record(value * 1000);
+          }
+        });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 1000U);
+  EXPECT_EQ(snapshot.max, 1000000U);
+  EXPECT_DOUBLE_EQ(snapshot.Mean(), 500500.0);
+  for (double quantile : { 0.01, 0.5, 0.9, 0.99, 0.999 })
+  {
+    const double exact = quantile * 1000 * 1000;
+    EXPECT_GE(static_cast<double>(snapshot.Percentile(quantile)), exact);
+    EXPECT_LE(static_cast<double>(snapshot.Percentile(quantile)), exact * 1.125);
+  }
+  EXPECT_EQ(snapshot.Percentile(1), 1000000U);
+}
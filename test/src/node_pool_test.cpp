@@ -0,0 +1,201 @@
+#include "mcpp/node_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <forward_list>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mcpp;  // NOLINT
+
+// built before the first allocation from its pool, so destroyed at exit after the pool would be if it were a static
+std::list<std::string, NodePoolAllocator<std::string>> exit_list;  // NOLINT
+
+TEST(NodePoolTest, Containers)  // NOLINT
+{
+  std::list<int, NodePoolAllocator<int>> list{ 1, 2, 3 };
+  list.push_front(0);
+  list.remove(2);
+  EXPECT_EQ(list, (std::list<int, NodePoolAllocator<int>>{ 0, 1, 3 }));
+
+  std::forward_list<std::string, NodePoolAllocator<std::string>> forward_list{ "b", "c" };
+  forward_list.push_front("a");
+  EXPECT_EQ(forward_list.front(), "a");
+
+  std::map<int, std::string, std::less<>, NodePoolAllocator<std::pair<const int, std::string>>> map;
+  for (int i = 0; i < 1000; ++i)
+  {
+    map.emplace(i, std::to_string(i));
+  }
+  map.erase(500);
+  EXPECT_EQ(map.size(), 999);
+  EXPECT_EQ(map.at(999), "999");
+  EXPECT_EQ(map.count(500), 0);
+}
+
+TEST(NodePoolTest, Locality)  // NOLINT
+{
+  // nodes allocated one after another by a fresh thread are adjacent in the slab
+  std::thread(
+      []()
+      {
+        using Node = std::list<std::int64_t, NodePoolAllocator<std::int64_t>>;
+        Node list;
+        for (std::int64_t i = 0; i < 16; ++i)
+        {
+          list.push_back(i);
+        }
+        auto prev = reinterpret_cast<std::uintptr_t>(&list.front());  // NOLINT
+        std::uintptr_t step = 0;
+        for (auto it = std::next(list.begin()); it != list.end(); ++it)
+        {
+          auto cur = reinterpret_cast<std::uintptr_t>(&*it);  // NOLINT
+          if (step == 0)
+          {
+            step = cur - prev;
+          }
+          EXPECT_EQ(cur - prev, step);
+          prev = cur;
+        }
+        EXPECT_LE(step, 64U);
+      })
+      .join();
+}
+
+TEST(NodePoolTest, CrossThread)  // NOLINT
+{
+  using Pool = NodePool<48, 8>;
+  // allocated here, freed by another thread: the block joins that thread's free list, and is handed back to the pool
+  // when the thread exits
+  void* p = Pool::allocate();
+  std::thread([p]() { Pool::deallocate(p); }).join();
+
+  const std::size_t slabs = Pool::slab_count();
+  std::thread(
+      [slabs]()
+      {
+        // the first refill of a new thread reuses the orphaned blocks instead of allocating a slab
+        void* q = Pool::allocate();
+        EXPECT_EQ(Pool::slab_count(), slabs);
+        Pool::deallocate(q);
+      })
+      .join();
+}
+
+TEST(NodePoolTest, DestroyedAtExit)  // NOLINT
+{
+  // the nodes are freed into the pool by the destructor of exit_list, after main returns
+  for (int i = 0; i < 100; ++i)
+  {
+    exit_list.push_back(std::to_string(i));
+  }
+  EXPECT_EQ(exit_list.size(), 100U);
+}
+
+TEST(NodePoolTest, FreedAfterThreadExit)  // NOLINT
+{
+  using Pool = NodePool<136, 8>;
+  // the blocks of a thread_local constructed before the first allocation of the thread are freed after its free list was
+  // given back to the pool: they must reach the pool too
+  struct Holder
+  {
+    std::vector<void*> blocks;
+    Holder() = default;
+    Holder(const Holder&) = delete;
+    Holder& operator=(const Holder&) = delete;
+    ~Holder()
+    {
+      for (void* p : blocks)
+      {
+        Pool::deallocate(p);
+      }
+    }
+  };
+  std::thread(
+      []()
+      {
+        thread_local Holder holder;
+        for (int i = 0; i < 100; ++i)
+        {
+          holder.blocks.push_back(Pool::allocate());
+        }
+      })
+      .join();
+
+  // 32 + 64 + 128 blocks carved: the 100 freed at exit, plus the rest, serve 200 allocations without a new slab
+  const std::size_t slabs = Pool::slab_count();
+  std::thread(
+      [slabs]()
+      {
+        std::vector<void*> blocks;
+        for (int i = 0; i < 200; ++i)
+        {
+          blocks.push_back(Pool::allocate());
+        }
+        EXPECT_EQ(Pool::slab_count(), slabs);
+        for (void* p : blocks)
+        {
+          Pool::deallocate(p);
+        }
+      })
+      .join();
+}
+
+TEST(NodePoolTest, ProducerConsumer)  // NOLINT
+{
+  using Pool = NodePool<40, 8>;
+  // this thread allocates, another frees: the blocks go back to the pool past the free list limit of the consumer, and
+  // the producer takes them again instead of carving new slabs
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<void*> handoff;
+  bool done = false;
+  std::thread consumer(
+      [&]()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+          cv.wait(lock, [&]() { return !handoff.empty() || done; });
+          if (handoff.empty())
+          {
+            return;
+          }
+          for (void* p : handoff)
+          {
+            Pool::deallocate(p);
+          }
+          handoff.clear();
+          cv.notify_all();
+        }
+      });
+
+  for (int round = 0; round < 100; ++round)
+  {
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1000; ++i)
+    {
+      blocks.push_back(Pool::allocate());
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    handoff = std::move(blocks);
+    cv.notify_all();
+    cv.wait(lock, [&]() { return handoff.empty(); });
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  cv.notify_all();
+  consumer.join();
+
+  // 1000 blocks in flight, plus the free lists: 32 + 64 + ... + 1024 blocks
+  EXPECT_LE(Pool::slab_count(), 6U);
+}
@@ -0,0 +1,90 @@
+#include "mcpp/small_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace vector;  // NOLINT
+
+TEST(SmallVectorTest, Test)  // NOLINT
+{
+  auto vector = SmallVector<int, 4>(3);
+  vector[0] = 1;
+  EXPECT_EQ(vector[0], 1);
+  EXPECT_EQ(vector.size(), 3);
+  EXPECT_EQ(vector[1], 0);
+  EXPECT_TRUE(vector.is_inline());
+
+  auto vector2 = SmallVector<double, 4>{ 1, 2, 3 };
+  vector2[2] = 4.1;  // NOLINT
+  EXPECT_EQ(vector2[2], 4.1);
+  EXPECT_EQ(vector2.size(), 3);
+
+  // copy constructor
+  auto vector3 = SmallVector<int, 4>{ vector };
+  EXPECT_EQ(vector3[0], 1);
+  // copy assignment
+  SmallVector<int, 4> vector4{};
+  vector4 = vector3;
+  EXPECT_EQ(vector4[0], 1);
+
+  // move constructor
+  auto vector5 = SmallVector<int, 4>{ std::move(vector4) };
+  EXPECT_EQ(vector5[0], 1);
+  // move assignment
+  SmallVector<int, 4> vector6{};
+  vector6 = std::move(vector5);
+  EXPECT_EQ(vector6[0], 1);
+
+  // read-only access through a const reference
+  const SmallVector<int, 4>& view = vector6;
+  EXPECT_EQ(view.size(), 3);
+  EXPECT_EQ(view[0], 1);
+  int sum = 0;
+  for (int value : view)
+  {
+    sum += value;
+  }
+  EXPECT_EQ(sum, 1);
+}
+
+TEST(SmallVectorTest, Spill)  // NOLINT
+{
+  SmallVector<std::string, 4> v{};
+  for (int i = 0; i < 4; ++i)
+  {
+    v.emplace_back(std::to_string(i));
+  }
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.capacity(), 4);
+
+  // the 5th element spills to the heap
+  v.push_back("4");
+  EXPECT_FALSE(v.is_inline());
+  EXPECT_EQ(v.capacity(), 8);
+  EXPECT_EQ(v[0], "0");
+  EXPECT_EQ(v[4], "4");
+
+  // heap storage is stolen by a move
+  std::string* heap = v.begin();
+  SmallVector<std::string, 4> moved{ std::move(v) };
+  EXPECT_EQ(moved.begin(), heap);
+  EXPECT_EQ(moved.size(), 5);
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.size(), 0);
+
+  // back to the inline buffer when it fits again
+  SmallVector<std::string, 4> small{ "a", "b" };
+  moved = std::move(small);
+  EXPECT_TRUE(moved.is_inline());
+  EXPECT_EQ(moved.size(), 2);
+  EXPECT_EQ(moved[1], "b");
+
+  SmallVector<std::string, 4> shrunk{};
+  shrunk.reserve(16);
+  shrunk.emplace_back("x");
+  EXPECT_FALSE(shrunk.is_inline());
+  shrunk.shrink_to_fit();
+  EXPECT_TRUE(shrunk.is_inline());
+  EXPECT_EQ(shrunk[0], "x");
+}
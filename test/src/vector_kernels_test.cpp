@@ -0,0 +1,89 @@
+#include "mcpp/vector_kernels.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vector;  // NOLINT
+
+// compare every instruction set the CPU supports against std algorithms, including the sizes that leave a scalar tail.
+TEST(VectorKernelsTest, AllIsas)  // NOLINT
+{
+  std::mt19937 engine(42);  // NOLINT
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+
+  for (auto isa : { kernels::Isa::Scalar, kernels::Isa::Sse41, kernels::Isa::Avx2 })
+  {
+    if (!kernels::supported(isa))
+    {
+      continue;
+    }
+    const kernels::Table& k = kernels::table(isa);
+    for (std::size_t n : std::initializer_list<std::size_t>{ 0, 1, 3, 4, 7, 8, 9, 31, 100, 1001 })
+    {
+      SCOPED_TRACE(std::string(kernels::isa_name(isa)) + " n=" + std::to_string(n));
+      std::vector<int> x(n);
+      std::vector<int> y(n);
+      std::generate(x.begin(), x.end(), [&]() { return dist(engine); });
+      std::generate(y.begin(), y.end(), [&]() { return dist(engine); });
+      // small integers are exact in double, so the double kernels can be compared with EXPECT_EQ too
+      std::vector<double> xd(x.begin(), x.end());
+      std::vector<double> yd(y.begin(), y.end());
+
+      EXPECT_EQ(k.sum_i32(x.data(), n), std::accumulate(x.begin(), x.end(), 0LL));
+      EXPECT_EQ(k.sum_f64(xd.data(), n), std::accumulate(xd.begin(), xd.end(), 0.0));
+      constexpr double inf = std::numeric_limits<double>::infinity();
+      EXPECT_EQ(k.min_i32(x.data(), n), n == 0 ? std::numeric_limits<int>::max() : *std::min_element(x.begin(), x.end()));
+      EXPECT_EQ(k.max_i32(x.data(), n), n == 0 ? std::numeric_limits<int>::min() : *std::max_element(x.begin(), x.end()));
+      EXPECT_EQ(k.min_f64(xd.data(), n), n == 0 ? inf : *std::min_element(xd.begin(), xd.end()));
+      EXPECT_EQ(k.max_f64(xd.data(), n), n == 0 ? -inf : *std::max_element(xd.begin(), xd.end()));
+      EXPECT_EQ(k.dot_i32(x.data(), y.data(), n), std::inner_product(x.begin(), x.end(), y.begin(), 0LL));
+      EXPECT_EQ(k.dot_f64(xd.data(), yd.data(), n), std::inner_product(xd.begin(), xd.end(), yd.begin(), 0.0));
+
+      std::vector<int> axpy = y;
+      k.axpy_i32(3, x.data(), axpy.data(), n);
+      std::vector<double> axpyd = yd;
+      k.axpy_f64(3, xd.data(), axpyd.data(), n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        EXPECT_EQ(axpy[i], 3 * x[i] + y[i]);
+        EXPECT_EQ(axpyd[i], 3 * xd[i] + yd[i]);
+      }
+
+      std::vector<int> scan = x;
+      k.prefix_sum_i32(scan.data(), n);
+      std::vector<double> scand = xd;
+      k.prefix_sum_f64(scand.data(), n);
+      std::vector<int> expected(n);
+      std::partial_sum(x.begin(), x.end(), expected.begin());
+      EXPECT_EQ(scan, expected);
+      EXPECT_EQ(scand, std::vector<double>(expected.begin(), expected.end()));
+    }
+  }
+}
+
+TEST(VectorKernelsTest, Vector)  // NOLINT
+{
+  auto x = Vector<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  auto y = Vector<int>(10);
+  EXPECT_EQ(kernels::sum(x), 55);
+  EXPECT_EQ(kernels::min(x), 1);
+  EXPECT_EQ(kernels::max(x), 10);
+
+  kernels::axpy(2, x, y);
+  EXPECT_EQ(y[9], 20);
+  EXPECT_EQ(kernels::dot(x, y), 2 * 385);
+
+  kernels::prefix_sum(x);
+  EXPECT_EQ(x[9], 55);
+
+  auto d = Vector<double>{ 0.5, 1.5, -2 };
+  EXPECT_EQ(kernels::sum(d), 0);
+  EXPECT_EQ(kernels::min(d), -2);
+}
@@ -2,8 +2,29 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+
 using namespace vector;  // NOLINT
 
+// owns a heap object through std::unique_ptr, which is safe to move with memcpy
+struct Boxed
+{
+  std::unique_ptr<int> value;
+  explicit Boxed(int v) : value(std::make_unique<int>(v))
+  {
+  }
+};
+
+template<>
+struct vector::is_trivially_relocatable<Boxed> : std::true_type
+{
+};
+
 TEST(VectorTest, Test)  // NOLINT
 {
   auto vector = Vector<int>(3);
@@ -33,3 +54,130 @@ TEST(VectorTest, Test)  // NOLINT
   vector6 = std::move(vector5);
   EXPECT_EQ(vector6[0], 1);
 }
+
+TEST(VectorTest, Growth)  // NOLINT
+{
+  Vector<int> v{};
+  EXPECT_EQ(v.capacity(), 0);
+  for (int i = 0; i < 100; ++i)
+  {
+    v.push_back(i);
+  }
+  EXPECT_EQ(v.size(), 100);
+  EXPECT_GE(v.capacity(), 100);
+  EXPECT_EQ(v[99], 99);
+
+  // geometric growth: capacity is always a power of two when growing from empty
+  EXPECT_EQ(v.capacity(), 128);
+
+  v.shrink_to_fit();
+  EXPECT_EQ(v.capacity(), 100);
+
+  v.reserve(10);
+  EXPECT_EQ(v.capacity(), 100);
+  v.reserve(1000);
+  EXPECT_EQ(v.capacity(), 1000);
+  EXPECT_EQ(v[50], 50);
+
+  // emplace_back an element of itself must be safe across reallocation
+  Vector<int> v2{ 1 };
+  v2.emplace_back(v2[0]);
+  v2.emplace_back(v2[1]);
+  EXPECT_EQ(v2.size(), 3);
+  EXPECT_EQ(v2[2], 1);
+}
+
+TEST(VectorTest, EmplaceBack)  // NOLINT
+{
+  Vector<std::string> v{};
+  v.reserve(2);
+  v.emplace_back(3U, 'a');
+  v.push_back("b");
+  // reallocation moves the strings (noexcept move constructor)
+  v.emplace_back("c");
+  EXPECT_EQ(v.size(), 3);
+  EXPECT_EQ(v.capacity(), 4);
+  EXPECT_EQ(v[0], "aaa");
+  EXPECT_EQ(v[2], "c");
+}
+
+TEST(VectorTest, TriviallyRelocatable)  // NOLINT
+{
+  static_assert(is_trivially_relocatable_v<int>);
+  static_assert(is_trivially_relocatable_v<double>);
+  static_assert(!is_trivially_relocatable_v<std::string>);
+  static_assert(is_trivially_relocatable_v<Boxed>);
+
+  // reallocation of an opt-in type is a memcpy, the heap objects must neither leak nor be freed twice
+  Vector<Boxed> v{};
+  for (int i = 0; i < 100; ++i)
+  {
+    v.emplace_back(i);
+  }
+  v.shrink_to_fit();
+  EXPECT_EQ(v.size(), 100);
+  EXPECT_EQ(*v[0].value, 0);
+  EXPECT_EQ(*v[99].value, 99);
+
+  // copy of a trivially copyable type is a memcpy
+  Vector<int> ints{ 1, 2, 3 };
+  Vector<int> copied{ ints };
+  ints[0] = 0;
+  EXPECT_EQ(copied[0], 1);
+  EXPECT_EQ(copied[2], 3);
+}
+
+TEST(VectorTest, CountingTrace)  // NOLINT
+{
+  using CountedVector = Vector<int, std::allocator<int>, CountingTrace>;
+  CountingTrace::reset();
+  {
+    CountedVector v{};
+    v.push_back(1);
+    CountedVector copied{ v };           // copy constructor
+    copied = v;                          // copy assignment
+    CountedVector moved{ std::move(v) };  // move constructor
+    moved = std::move(copied);           // move assignment
+  }
+  EXPECT_EQ(CountingTrace::count(SpecialMember::CopyConstructor), 1U);
+  EXPECT_EQ(CountingTrace::count(SpecialMember::CopyAssignment), 1U);
+  EXPECT_EQ(CountingTrace::count(SpecialMember::MoveConstructor), 1U);
+  EXPECT_EQ(CountingTrace::count(SpecialMember::MoveAssignment), 1U);
+  EXPECT_EQ(CountingTrace::count(SpecialMember::Destructor), 3U);
+
+  // the counters are per thread
+  std::size_t other_thread_count = 1;
+  std::thread([&other_thread_count]() { other_thread_count = CountingTrace::count(SpecialMember::Destructor); }).join();
+  EXPECT_EQ(other_thread_count, 0U);
+}
+
+TEST(VectorTest, PolymorphicAllocator)  // NOLINT
+{
+  using PmrVector = Vector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>>;
+
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena{ buffer.data(), buffer.size(), std::pmr::null_memory_resource() };
+  PmrVector v{ &arena };
+  for (int i = 0; i < 10; ++i)
+  {
+    // uses-allocator construction: the strings allocate from the arena too
+    v.emplace_back(32U, 'a');
+  }
+  EXPECT_EQ(v.size(), 10);
+  EXPECT_EQ(v.get_allocator().resource(), &arena);
+  EXPECT_EQ(v[9].get_allocator().resource(), &arena);
+
+  // polymorphic_allocator does not propagate, so moving into a vector with another resource moves the elements one by one
+  PmrVector other{ std::pmr::new_delete_resource() };
+  other = std::move(v);
+  EXPECT_EQ(other.size(), 10);
+  EXPECT_EQ(other.get_allocator().resource(), std::pmr::new_delete_resource());
+  EXPECT_EQ(other[0], std::pmr::string(32U, 'a'));
+  EXPECT_EQ(other[0].get_allocator().resource(), std::pmr::new_delete_resource());
+  EXPECT_EQ(v.size(), 0);
+
+  // copy construction selects the default resource, not the one of the source
+  PmrVector copied{ other };
+  EXPECT_EQ(copied.get_allocator().resource(), std::pmr::get_default_resource());
+  EXPECT_EQ(copied[9], other[9]);
+}